@@ -0,0 +1,286 @@
+#pragma once
+
+#include <array>        // std::array
+#include <coroutine>    // std::coroutine_handle, std::suspend_always, std::suspend_never
+#include <cstddef>      // std::size_t
+#include <exception>    // std::terminate
+#include <iterator>     // std::input_iterator
+#include <mutex>        // std::mutex, std::lock_guard, std::unique_lock
+#include <optional>     // std::optional
+#include <span>         // std::span
+#include <type_traits>  // std::is_nothrow_move_constructible_v
+#include <utility>      // std::exchange, std::forward, std::move
+
+#include "ShiftToMiddleArray.h"
+
+namespace stm {
+
+// Where an AsyncShiftToMiddleQueue resumes the coroutines it wakes: post()
+// receives every handle released by one push/push_batch/close call at once
+// (in chunks of up to 64), so an executor can enqueue them under one lock or
+// with one wake-up.
+template <typename E>
+concept coroutine_executor = requires(E& executor, std::span<const std::coroutine_handle<>> handles) {
+	executor.post(handles);
+};
+
+// Single-threaded event loop: post() queues handles, run() resumes them in
+// FIFO order until none are left. Meant for tests and for services that keep
+// all their coroutines on one thread.
+class LocalEventLoop {
+	ShiftToMiddleArray<std::coroutine_handle<>> ready_;
+
+public:
+	// Fire-and-forget coroutine started with spawn(). It runs on the loop, and
+	// its frame is freed when it finishes; an exception escaping it terminates.
+	class Task {
+	public:
+		struct promise_type {
+			Task get_return_object() noexcept { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept { std::terminate(); }
+		};
+
+		Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+		Task& operator=(Task&&) = delete;
+
+		// A task that was never spawned is destroyed unstarted
+		~Task() {
+			if (handle_) handle_.destroy();
+		}
+
+	private:
+		friend class LocalEventLoop;
+		explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+		std::coroutine_handle<promise_type> handle_;
+	};
+
+	void spawn(Task task) { ready_.push_back(std::exchange(task.handle_, nullptr)); }
+
+	void post(std::coroutine_handle<> handle) { ready_.push_back(handle); }
+
+	void post(std::span<const std::coroutine_handle<>> handles) {
+		for (std::coroutine_handle<> h : handles) ready_.push_back(h);
+	}
+
+	// co_await loop.yield(): go to the back of the ready queue
+	auto yield() noexcept {
+		struct Awaiter {
+			LocalEventLoop& loop;
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> h) { loop.post(h); }
+			void await_resume() const noexcept {}
+		};
+		return Awaiter{*this};
+	}
+
+	// Resumes ready coroutines until there are none; returns how many resumptions
+	size_t run() {
+		size_t resumed = 0;
+		while (!ready_.empty()) {
+			std::coroutine_handle<> h = ready_.front();
+			ready_.pop_front();
+			h.resume();
+			++resumed;
+		}
+		return resumed;
+	}
+
+	bool idle() const noexcept { return ready_.empty(); }
+};
+
+} // namespace stm
+
+// Queue whose consumers are coroutines: `co_await queue.pop()` yields the front
+// element, suspending while the queue is empty instead of polling empty().
+//
+// A suspended pop is a node in an intrusive FIFO list of waiters that lives in
+// the awaiting coroutine's frame, so waiting allocates nothing. A push hands
+// its element straight to the oldest waiter (it never enters the buffer) and
+// posts the waiter's handle to the executor; push_batch and close release all
+// the waiters they serve with one post() per 64 handles. Resumption always goes
+// through the executor, never inline in push(), so a producer is not re-entered
+// by its consumers.
+//
+// Producers and consumers may run on any threads (the buffer and the waiter
+// list are guarded by a mutex); the executor's post() is called without the
+// mutex held and must be safe to call from the producing threads.
+//
+// close() ends the input: pops still receive the queued elements, then
+// std::nullopt, and suspended pops are resumed with std::nullopt. A coroutine
+// must not be destroyed while suspended in pop().
+template <typename T, stm::coroutine_executor Executor = stm::LocalEventLoop>
+class AsyncShiftToMiddleQueue {
+public:
+	class PopAwaiter;
+
+private:
+	Executor& executor_;
+	std::mutex mutex_;
+	ShiftToMiddleArray<T> buffer_;
+	PopAwaiter* first_waiter_ = nullptr;
+	PopAwaiter* last_waiter_ = nullptr;
+	bool closed_ = false;
+
+	PopAwaiter* take_waiter() noexcept {
+		PopAwaiter* w = first_waiter_;
+		first_waiter_ = w->next_;
+		if (!first_waiter_) last_waiter_ = nullptr;
+		w->next_ = nullptr;
+		return w;
+	}
+
+	// Posts a detached list of waiters, 64 handles per post(). Each node is
+	// read before its handle is posted: once resumed, its frame may be gone.
+	void resume_all(PopAwaiter* list) {
+		std::array<std::coroutine_handle<>, 64> batch;
+		size_t n = 0;
+		while (list) {
+			PopAwaiter* next = list->next_;
+			batch[n++] = list->handle_;
+			list = next;
+			if (n == batch.size()) {
+				executor_.post(std::span<const std::coroutine_handle<>>(batch.data(), n));
+				n = 0;
+			}
+		}
+		if (n > 0) executor_.post(std::span<const std::coroutine_handle<>>(batch.data(), n));
+	}
+
+	template <typename U>
+	bool push_one(U&& value) {
+		PopAwaiter* served = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (closed_) return false;
+			if (first_waiter_) {
+				// Unlinked only once it holds the value: a throwing T leaves it waiting
+				first_waiter_->value_.emplace(std::forward<U>(value));
+				served = take_waiter();
+			} else {
+				buffer_.push_back(std::forward<U>(value));
+			}
+		}
+		if (served) resume_all(served);
+		return true;
+	}
+
+public:
+	using value_type = T;
+
+	class PopAwaiter {
+		friend class AsyncShiftToMiddleQueue;
+
+		AsyncShiftToMiddleQueue& queue_;
+		std::optional<T> value_;
+		std::coroutine_handle<> handle_;
+		PopAwaiter* next_ = nullptr;
+
+		explicit PopAwaiter(AsyncShiftToMiddleQueue& queue) noexcept : queue_(queue) {}
+
+	public:
+		bool await_ready() const noexcept { return false; }
+
+		// Takes the front element without suspending if there is one (or the
+		// queue is closed); otherwise joins the waiter list
+		bool await_suspend(std::coroutine_handle<> handle) {
+			std::lock_guard<std::mutex> lock(queue_.mutex_);
+			if (!queue_.buffer_.empty()) {
+				value_.emplace(std::move(queue_.buffer_.front()));
+				queue_.buffer_.pop_front();
+				return false;
+			}
+			if (queue_.closed_) return false;
+			handle_ = handle;
+			if (queue_.last_waiter_) queue_.last_waiter_->next_ = this;
+			else queue_.first_waiter_ = this;
+			queue_.last_waiter_ = this;
+			return true;
+		}
+
+		// The element, or std::nullopt once the queue is closed and drained
+		std::optional<T> await_resume() noexcept(std::is_nothrow_move_constructible_v<T>) { return std::move(value_); }
+	};
+
+	explicit AsyncShiftToMiddleQueue(Executor& executor) : executor_(executor) {}
+
+	AsyncShiftToMiddleQueue(const AsyncShiftToMiddleQueue&) = delete;
+	AsyncShiftToMiddleQueue& operator=(const AsyncShiftToMiddleQueue&) = delete;
+
+	// Consumers
+
+	// co_await queue.pop() -> std::optional<T>
+	PopAwaiter pop() noexcept { return PopAwaiter(*this); }
+
+	std::optional<T> try_pop() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (buffer_.empty()) return std::nullopt;
+		std::optional<T> value(std::move(buffer_.front()));
+		buffer_.pop_front();
+		return value;
+	}
+
+	// Producers
+
+	// False (value dropped) once the queue is closed
+	bool push(const T& value) { return push_one(value); }
+	bool push(T&& value) { return push_one(std::move(value)); }
+
+	// Queues n elements from first under one lock, serving waiters first, and
+	// resumes the served waiters together. Returns how many were queued (0 if
+	// the queue is closed). If constructing an element throws, the elements
+	// before it stay queued and the waiters they served are still resumed.
+	template <std::input_iterator InputIt>
+	size_t push_batch(InputIt first, size_t n) {
+		PopAwaiter* served = nullptr;
+		PopAwaiter* served_last = nullptr;
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (closed_) return 0;
+		try {
+			for (size_t i = 0; i < n; ++i, ++first) {
+				if (!first_waiter_) {
+					buffer_.push_back(*first);
+					continue;
+				}
+				first_waiter_->value_.emplace(*first);
+				PopAwaiter* w = take_waiter();
+				if (served_last) served_last->next_ = w;
+				else served = w;
+				served_last = w;
+			}
+		} catch (...) {
+			lock.unlock();
+			resume_all(served);
+			throw;
+		}
+		lock.unlock();
+		resume_all(served);
+		return n;
+	}
+
+	// Ends the input and resumes every suspended pop with std::nullopt. Idempotent.
+	void close() {
+		PopAwaiter* waiters;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+			waiters = std::exchange(first_waiter_, nullptr);
+			last_waiter_ = nullptr;
+		}
+		resume_all(waiters);
+	}
+
+	// Snapshots; other threads may change them right after
+
+	size_t size() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return buffer_.size();
+	}
+
+	bool closed() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return closed_;
+	}
+};
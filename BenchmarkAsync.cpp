@@ -0,0 +1,126 @@
+#include "BenchmarkAsync.h"
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <thread>
+
+using namespace std;
+
+static double mean_of(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / static_cast<double>(v.size());
+}
+
+// Coroutine side: `consumers` coroutines awaiting pop() and one producer
+// coroutine, all on one LocalEventLoop. The producer pushes `batch` items
+// (one push each, or one push_batch) and then yields to let them run.
+
+static stm::LocalEventLoop::Task async_consume(AsyncShiftToMiddleQueue<int>& q, long long& sum) {
+    while (std::optional<int> v = co_await q.pop()) sum += *v;
+}
+
+static stm::LocalEventLoop::Task async_produce(stm::LocalEventLoop& loop, AsyncShiftToMiddleQueue<int>& q, int items, int batch, bool batched) {
+    std::vector<int> buffer(static_cast<size_t>(batch));
+    for (int i = 0; i < items;) {
+        const int n = std::min(batch, items - i);
+        if (batched) {
+            std::iota(buffer.begin(), buffer.begin() + n, i);
+            q.push_batch(buffer.begin(), static_cast<size_t>(n));
+        } else {
+            for (int k = 0; k < n; ++k) q.push(i + k);
+        }
+        i += n;
+        co_await loop.yield();
+    }
+    q.close();
+}
+
+static double benchmark_coroutines(int items, int consumers, bool batched) {
+    stm::LocalEventLoop loop;
+    AsyncShiftToMiddleQueue<int> q(loop);
+    long long sum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int c = 0; c < consumers; ++c) loop.spawn(async_consume(q, sum));
+    loop.spawn(async_produce(loop, q, items, 64, batched));
+    loop.run();
+    auto end = chrono::steady_clock::now();
+    if (sum != static_cast<long long>(items) * (items - 1) / 2) cout << "coroutine hand-off lost items\n";
+    return items / chrono::duration<double>(end - start).count() / 1e6;
+}
+
+// Thread side: `consumers` threads blocked on a condition variable, fed by the
+// calling thread
+static double benchmark_condvar(int items, int consumers) {
+    std::mutex m;
+    std::condition_variable ready;
+    std::queue<int> q;
+    bool closed = false;
+    std::vector<long long> sums(static_cast<size_t>(consumers), 0);
+
+    auto start = chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            long long sum = 0;
+            for (;;) {
+                std::unique_lock<std::mutex> lock(m);
+                ready.wait(lock, [&] { return !q.empty() || closed; });
+                if (q.empty()) break;
+                sum += q.front();
+                q.pop();
+            }
+            sums[static_cast<size_t>(c)] = sum;
+        });
+    }
+    for (int i = 0; i < items; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            q.push(i);
+        }
+        ready.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m);
+        closed = true;
+    }
+    ready.notify_all();
+    for (std::thread& t : threads) t.join();
+    auto end = chrono::steady_clock::now();
+    if (std::accumulate(sums.begin(), sums.end(), 0LL) != static_cast<long long>(items) * (items - 1) / 2) cout << "condvar hand-off lost items\n";
+    return items / chrono::duration<double>(end - start).count() / 1e6;
+}
+
+void run_benchmarks_async(int items) {
+    int runs = 5; // Number of benchmark runs to average
+    vector<int> consumer_counts = {1, 4, 16, 64};
+
+    ofstream results_file("benchmark_results_async.csv");
+    results_file << "Items,Consumers,Type,MitemsPerSecMean\n";
+
+    cout << "Benchmarking hand-off of " << items << " items to waiting consumers (coroutines on one event loop vs threads on a condvar): \n\n";
+
+    const char* names[3] = {"condvar + std::queue (threads)", "AsyncShiftToMiddleQueue push", "AsyncShiftToMiddleQueue push_batch"};
+    for (int consumers : consumer_counts) {
+        std::array<std::vector<double>, 3> results;
+        for (int i = 0; i < runs; ++i) {
+            results[0].push_back(benchmark_condvar(items, consumers));
+            results[1].push_back(benchmark_coroutines(items, consumers, false));
+            results[2].push_back(benchmark_coroutines(items, consumers, true));
+        }
+
+        cout << "Consumers: " << consumers << "\n";
+        for (int j = 0; j < 3; ++j) {
+            cout << names[j] << " - " << mean_of(results[j]) << " Mitems/s\n";
+            results_file << items << "," << consumers << "," << names[j] << "," << mean_of(results[j]) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_async.csv\n";
+}
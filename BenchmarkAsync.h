@@ -0,0 +1,8 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include "AsyncShiftToMiddleQueue.h"
+
+void run_benchmarks_async(int items);
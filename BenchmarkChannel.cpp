@@ -0,0 +1,155 @@
+#include "BenchmarkChannel.h"
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+using namespace std;
+
+static double mean_of(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / static_cast<double>(v.size());
+}
+
+// The ad-hoc baseline: a std::queue with a mutex and two condition variables,
+// bounded at `capacity`, closed by a flag
+class CondvarQueue {
+    std::mutex m;
+    std::condition_variable not_full, not_empty;
+    std::queue<int> q;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit CondvarQueue(size_t cap) : capacity(cap) {}
+
+    void push(int v) {
+        std::unique_lock<std::mutex> lock(m);
+        not_full.wait(lock, [&] { return q.size() < capacity; });
+        q.push(v);
+        not_empty.notify_one();
+    }
+
+    bool pop(int& v) {
+        std::unique_lock<std::mutex> lock(m);
+        not_empty.wait(lock, [&] { return !q.empty() || closed; });
+        if (q.empty()) return false;
+        v = q.front();
+        q.pop();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(m);
+        closed = true;
+        not_empty.notify_all();
+    }
+};
+
+// `threads` producers and as many consumers move `items` ints through a channel
+// of 1024 elements, one at a time (batch 1) or in batches. Returns Mitems/s.
+template <typename Run>
+double benchmark_channel(int items, int threads, Run&& run) {
+    const int per_producer = items / threads;
+    auto start = chrono::steady_clock::now();
+    run(per_producer);
+    auto end = chrono::steady_clock::now();
+    return static_cast<double>(per_producer) * threads / chrono::duration<double>(end - start).count() / 1e6;
+}
+
+static double run_channel(int items, int threads, size_t batch) {
+    return benchmark_channel(items, threads, [&](int per_producer) {
+        ShiftToMiddleChannel<int> ch(1024, 512);
+        std::vector<std::thread> producers, consumers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([&] {
+                std::vector<int> buffer(batch);
+                for (int i = 0; i < per_producer;) {
+                    if (batch == 1) {
+                        ch.push(i++);
+                        continue;
+                    }
+                    const size_t n = std::min(batch, static_cast<size_t>(per_producer - i));
+                    for (size_t k = 0; k < n; ++k) buffer[k] = i++;
+                    ch.push_batch(buffer.begin(), n);
+                }
+            });
+            consumers.emplace_back([&] {
+                std::vector<int> buffer(batch);
+                long long sum = 0;
+                if (batch == 1) {
+                    while (std::optional<int> v = ch.pop()) sum += *v;
+                } else {
+                    while (size_t n = ch.pop_batch(buffer.begin(), batch)) {
+                        for (size_t k = 0; k < n; ++k) sum += buffer[k];
+                    }
+                }
+                if (sum == -1) cout << "";  // keep the reads alive
+            });
+        }
+        for (std::thread& t : producers) t.join();
+        ch.close();
+        for (std::thread& t : consumers) t.join();
+    });
+}
+
+static double run_condvar(int items, int threads) {
+    return benchmark_channel(items, threads, [&](int per_producer) {
+        CondvarQueue q(1024);
+        std::vector<std::thread> producers, consumers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([&] {
+                for (int i = 0; i < per_producer; ++i) q.push(i);
+            });
+            consumers.emplace_back([&] {
+                long long sum = 0;
+                int v;
+                while (q.pop(v)) sum += v;
+                if (sum == -1) cout << "";
+            });
+        }
+        for (std::thread& t : producers) t.join();
+        q.close();
+        for (std::thread& t : consumers) t.join();
+    });
+}
+
+void run_benchmarks_channel(int items) {
+    int runs = 5; // Number of benchmark runs to average
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) cores = 1;
+
+    // 1, 2, 4, ... producer/consumer pairs, at least up to 4
+    vector<int> thread_counts;
+    for (int t = 1; t <= static_cast<int>(std::max(cores, 4u)); t *= 2) thread_counts.push_back(t);
+
+    ofstream results_file("benchmark_results_channel.csv");
+    results_file << "Items,ProducerConsumerPairs,Type,MitemsPerSecMean\n";
+
+    cout << "Benchmarking bounded MPMC hand-off of " << items << " items (N producers, N consumers, capacity 1024): \n\n";
+
+    const char* names[3] = {"mutex + condvar + std::queue", "ShiftToMiddleChannel", "ShiftToMiddleChannel, batch 64"};
+    for (int threads : thread_counts) {
+        std::array<std::vector<double>, 3> results;
+        for (int i = 0; i < runs; ++i) {
+            results[0].push_back(run_condvar(items, threads));
+            results[1].push_back(run_channel(items, threads, 1));
+            results[2].push_back(run_channel(items, threads, 64));
+        }
+
+        cout << "Pairs: " << threads << "\n";
+        for (int j = 0; j < 3; ++j) {
+            cout << names[j] << " - " << mean_of(results[j]) << " Mitems/s\n";
+            results_file << items << "," << threads << "," << names[j] << "," << mean_of(results[j]) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_channel.csv\n";
+}
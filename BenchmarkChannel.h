@@ -0,0 +1,8 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include "ShiftToMiddleChannel.h"
+
+void run_benchmarks_channel(int items);
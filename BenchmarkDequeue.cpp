@@ -111,3 +111,76 @@ void run_benchmarks_deque(int operations) {
     results_file.close();
     std::cout << "Results saved to benchmark_results_deque.csv\n";
 }
+
+struct CenteredPolicy : stm::DefaultPolicy {
+    static constexpr float bias_step = 0.0f;
+};
+
+struct AdaptiveBiasPolicy : stm::DefaultPolicy {
+    static constexpr bool adaptive_bias = true;
+};
+
+// Lopsided traffic: back_percent of the pushes go to the back and the same share
+// of the pops to the front, so the contents drift towards the back end.
+template <typename DequeueType>
+double benchmark_deque_skew(int size, int operations, int back_percent, const int iterations = 10) {
+    std::mt19937 rng(42); // Fixed seed for reproducibility
+    DequeueType dequeue(10);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        for (int j = 0; j < size; ++j) {
+            if (static_cast<int>(rng() % 100) < back_percent) dequeue.push_back(j);
+            else dequeue.push_front(j);
+        }
+
+        for (int j = 0; j < operations; ++j) {
+            const bool at_back = static_cast<int>(rng() % 100) < back_percent;
+            if (rng() % 3 != 0) {
+                if (at_back) dequeue.push_back(j);
+                else dequeue.push_front(j);
+            } else if (!dequeue.empty()) {
+                if (at_back) dequeue.pop_front();
+                else dequeue.pop_back();
+            }
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void run_benchmarks_deque_skew(int operations) {
+    std::vector<int> test_sizes = {1000, 100000};
+    std::vector<int> skews = {50, 75, 90, 99};
+    int runs = 8; // Number of benchmark runs to average
+
+    std::ofstream results_file("benchmark_results_deque_skew.csv");
+    results_file << "Size,BackPercent,Type,TimeMeanMs,TimeStdMs\n";
+
+    std::cout << "Benchmarking bias strategies across push_back/push_front skews:\n\n";
+
+    for (int size : test_sizes) {
+        for (int skew : skews) {
+            std::array<std::vector<double>, 4> times;
+            for (int i = 0; i < runs; ++i) {
+                times[0].push_back(benchmark_deque_skew<std::deque<int>>(size, operations, skew));
+                times[1].push_back(benchmark_deque_skew<ShiftToMiddleArray<int, 2, std::allocator<int>, CenteredPolicy>>(size, operations, skew));
+                times[2].push_back(benchmark_deque_skew<ShiftToMiddleArray<int>>(size, operations, skew));
+                times[3].push_back(benchmark_deque_skew<ShiftToMiddleArray<int, 2, std::allocator<int>, AdaptiveBiasPolicy>>(size, operations, skew));
+            }
+
+            const char* names[4] = {"std::deque", "STM centered", "STM step bias", "STM adaptive bias"};
+            std::cout << "Container size: " << size << ", " << skew << "% at the back\n";
+            for (int j = 0; j < 4; ++j) {
+                double mean = mean_of(times[j]);
+                std::cout << names[j] << " (avg over " << runs << " runs): " << mean << " ms\n";
+                results_file << size << "," << skew << "," << names[j] << "," << mean << "," << stddev_of(times[j], mean) << "\n";
+            }
+            std::cout << "\n";
+        }
+    }
+    results_file.close();
+    std::cout << "Results saved to benchmark_results_deque_skew.csv\n";
+}
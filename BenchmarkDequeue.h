@@ -2,3 +2,4 @@
 #include "ShiftToMiddleArray.h"
 
 void run_benchmarks_deque(int operations);
+void run_benchmarks_deque_skew(int operations);
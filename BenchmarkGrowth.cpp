@@ -0,0 +1,186 @@
+#include "BenchmarkGrowth.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+static double mean_of(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / static_cast<double>(v.size());
+}
+
+// Tracks the bytes currently handed out and their high-water mark. During a
+// reallocation both blocks are live, so the peak includes that overlap.
+struct FootprintCounter {
+    static inline size_t live = 0;
+    static inline size_t peak = 0;
+    static void reset() { live = peak = 0; }
+};
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() noexcept = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        FootprintCounter::live += n * sizeof(T);
+        FootprintCounter::peak = std::max(FootprintCounter::peak, FootprintCounter::live);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        FootprintCounter::live -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    friend bool operator==(const CountingAllocator&, const CountingAllocator&) noexcept { return true; }
+};
+
+struct AdaptiveGrowthPolicy : stm::DefaultPolicy {
+    using growth = stm::AdaptiveGrowth<>;
+};
+
+// Fills a container by pushing at both ends (3:1 towards the back), then drains
+// half of it FIFO-style. Returns {time ms, peak bytes, final capacity bytes}.
+template <typename ContainerType>
+std::array<double, 3> benchmark_growth(int size) {
+    FootprintCounter::reset();
+    double elapsed;
+    size_t final_bytes;
+    {
+        ContainerType container;
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < size; ++i) {
+            if (i % 4 == 0) container.push_front(i);
+            else container.push_back(i);
+        }
+        for (int i = 0; i < size / 2; ++i) {
+            container.push_back(i);
+            container.pop_front();
+        }
+        auto end = chrono::high_resolution_clock::now();
+        elapsed = chrono::duration<double, milli>(end - start).count();
+        final_bytes = container.capacity() * sizeof(int);
+    }
+    return {elapsed, static_cast<double>(FootprintCounter::peak), static_cast<double>(final_bytes)};
+}
+
+void run_benchmarks_growth() {
+    vector<int> test_sizes = {1000, 100000, 1000000, 3000000, 6000000, 10000000};
+    int runs = 5; // Number of benchmark runs to average
+
+    ofstream results_file("benchmark_results_growth.csv");
+    results_file << "Size,Type,TimeMeanMs,PeakBytes,FinalCapacityBytes\n";
+
+    cout << "Benchmarking growth strategies (time and peak allocated bytes): \n\n";
+
+    for (int size : test_sizes) {
+        std::array<std::vector<double>, 2> times;
+        std::array<std::array<double, 3>, 2> last;
+        for (int i = 0; i < runs; ++i) {
+            last[0] = benchmark_growth<ShiftToMiddleArray<int, 2, CountingAllocator<int>>>(size);
+            last[1] = benchmark_growth<ShiftToMiddleArray<int, 2, CountingAllocator<int>, AdaptiveGrowthPolicy>>(size);
+            times[0].push_back(last[0][0]);
+            times[1].push_back(last[1][0]);
+        }
+
+        const char* names[2] = {"GeometricGrowth x2", "AdaptiveGrowth 1MiB"};
+        cout << "Test size: " << size << "\n";
+        for (int j = 0; j < 2; ++j) {
+            cout << names[j] << " - time: " << mean_of(times[j]) << " ms, peak: " << last[j][1] / 1024.0
+                 << " KiB, final capacity: " << last[j][2] / 1024.0 << " KiB\n";
+            results_file << size << "," << names[j] << "," << mean_of(times[j]) << "," << last[j][1] << "," << last[j][2] << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_growth.csv\n";
+}
+
+#ifdef __linux__
+struct ReallocatingShrinkPolicy : stm::DefaultPolicy {
+    static constexpr bool allow_shrinking = true;
+};
+
+// Resident set size of the process, from /proc/self/statm
+static double resident_mib() {
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1 << 20);
+}
+
+// Fills a queue with `size` ints, then drains it FIFO to size / 1000.
+// Returns {drain ms, slowest pop ns, resident MiB after the drain minus before the fill}.
+template <typename QueueType>
+std::array<double, 3> benchmark_drain(int size) {
+#ifdef __GLIBC__
+    malloc_trim(0);  // earlier runs' freed blocks would otherwise count against this one
+#endif
+    const double baseline = resident_mib();
+    QueueType queue;
+    for (int i = 0; i < size; ++i) queue.push_back(i);
+
+    double slowest = 0.0;
+    auto start = chrono::steady_clock::now();
+    while (queue.size() > static_cast<size_t>(size / 1000)) {
+        auto before = chrono::steady_clock::now();
+        queue.pop_front();
+        auto after = chrono::steady_clock::now();
+        slowest = std::max(slowest, chrono::duration<double, nano>(after - before).count());
+    }
+    auto end = chrono::steady_clock::now();
+    return {chrono::duration<double, milli>(end - start).count(), slowest, resident_mib() - baseline};
+}
+
+void run_benchmarks_shrink_release() {
+    vector<int> test_sizes = {1000000, 16000000, 64000000};
+    int runs = 3; // Number of benchmark runs to average
+
+    using Releasing = stm::PageReleasePolicy<stm::ShrinkMode::ReleasePages>;
+    using ReleasingLazily = stm::PageReleasePolicy<stm::ShrinkMode::ReleasePagesLazily>;
+
+    ofstream results_file("benchmark_results_shrink_release.csv");
+    results_file << "Size,Type,DrainMeanMs,SlowestPopNs,ResidentMiB\n";
+
+    cout << "Benchmarking shrinking by reallocation vs by page release (fill, then FIFO drain to 0.1%): \n\n";
+
+    for (int size : test_sizes) {
+        std::array<std::array<double, 3>, 3> totals{};
+        for (int i = 0; i < runs; ++i) {
+            const std::array<std::array<double, 3>, 3> r = {
+                benchmark_drain<ShiftToMiddleArray<int, 2, std::allocator<int>, ReallocatingShrinkPolicy>>(size),
+                benchmark_drain<ShiftToMiddleArray<int, 2, std::allocator<int>, Releasing>>(size),
+                benchmark_drain<ShiftToMiddleArray<int, 2, std::allocator<int>, ReleasingLazily>>(size),
+            };
+            for (int j = 0; j < 3; ++j) {
+                for (int k = 0; k < 3; ++k) totals[j][k] += r[j][k] / runs;
+            }
+        }
+
+        const char* names[3] = {"Reallocate", "ReleasePages (MADV_DONTNEED)", "ReleasePagesLazily (MADV_FREE)"};
+        cout << "Test size: " << size << "\n";
+        for (int j = 0; j < 3; ++j) {
+            cout << names[j] << " - drain: " << totals[j][0] << " ms, slowest pop: " << totals[j][1] / 1000.0
+                 << " us, resident after drain: " << totals[j][2] << " MiB\n";
+            results_file << size << "," << names[j] << "," << totals[j][0] << "," << totals[j][1] << "," << totals[j][2] << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_shrink_release.csv\n";
+}
+#endif
@@ -0,0 +1,11 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include "ShiftToMiddleArray.h"
+
+void run_benchmarks_growth();
+#ifdef __linux__
+void run_benchmarks_shrink_release();
+#endif
@@ -0,0 +1,133 @@
+#include "BenchmarkLatency.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+// p50, p99, p99.9 and max of a set of per-operation latencies, in nanoseconds
+static std::array<double, 4> percentiles_of(std::vector<double>& samples) {
+    if (samples.empty()) return {0.0, 0.0, 0.0, 0.0};
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * static_cast<double>(samples.size())))];
+    };
+    return {at(0.50), at(0.99), at(0.999), samples.back()};
+}
+
+// Times every push individually: a growth phase followed by FIFO traffic at
+// that size, which forces the shift-to-middle containers to recenter.
+template <typename QueueType>
+std::vector<double> benchmark_push_latency(int size, int operations) {
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(size) + static_cast<size_t>(operations));
+    std::mt19937 rng(42); // Fixed seed for reproducibility
+
+    QueueType queue;
+    for (int i = 0; i < size; ++i) {
+        auto before = chrono::steady_clock::now();
+        if (rng() % 4 == 0) queue.push_front(i);
+        else queue.push_back(i);
+        auto after = chrono::steady_clock::now();
+        samples.push_back(chrono::duration<double, nano>(after - before).count());
+    }
+
+    for (int i = 0; i < operations; ++i) {
+        auto before = chrono::steady_clock::now();
+        queue.push_back(i);
+        auto after = chrono::steady_clock::now();
+        samples.push_back(chrono::duration<double, nano>(after - before).count());
+        queue.pop_front();
+    }
+    return samples;
+}
+
+void run_benchmarks_latency(int operations) {
+    vector<int> test_sizes = {10000, 100000, 1000000, 4000000};
+
+    ofstream results_file("benchmark_results_latency.csv");
+    results_file << "Size,Type,P50Ns,P99Ns,P999Ns,MaxNs\n";
+
+    cout << "Benchmarking push tail latency (growth + FIFO): \n\n";
+
+    for (int size : test_sizes) {
+        std::array<std::vector<double>, 3> samples = {
+            benchmark_push_latency<std::deque<int>>(size, operations),
+            benchmark_push_latency<ShiftToMiddleArray<int>>(size, operations),
+            benchmark_push_latency<IncrementalShiftToMiddleArray<int>>(size, operations),
+        };
+
+        const char* names[3] = {"std::deque", "ShiftToMiddleArray", "IncrementalShiftToMiddleArray"};
+        cout << "Test size: " << size << "\n";
+        for (int j = 0; j < 3; ++j) {
+            auto p = percentiles_of(samples[j]);
+            cout << names[j] << " - p50: " << p[0] << " ns, p99: " << p[1] << " ns, p99.9: " << p[2]
+                 << " ns, max: " << p[3] << " ns\n";
+            results_file << size << "," << names[j] << "," << p[0] << "," << p[1] << "," << p[2] << "," << p[3] << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_latency.csv\n";
+}
+
+// Times one reallocation of a full block (reserve_back past the capacity) and
+// then one pass over a hot 8 MiB working set, which the copy may have evicted.
+// Returns {copy ms, working-set pass ms}.
+template <typename ArrayType>
+std::array<double, 2> benchmark_large_copy(int size, std::vector<int>& hot) {
+    ArrayType array;
+    array.reserve_back(static_cast<size_t>(size));
+    for (int i = 0; i < size; ++i) array.push_back(i);
+    long long sum = 0;
+    for (int v : hot) sum += v;  // warm the working set
+
+    auto start = chrono::steady_clock::now();
+    array.reserve_back(array.capacity() + 1);
+    auto copied = chrono::steady_clock::now();
+    for (int v : hot) sum += v;
+    auto end = chrono::steady_clock::now();
+
+    if (sum == 42 || array[static_cast<size_t>(size) / 2] != size / 2) cout << "";  // keep both alive
+    return {chrono::duration<double, milli>(copied - start).count(), chrono::duration<double, milli>(end - copied).count()};
+}
+
+void run_benchmarks_large_copy() {
+    vector<int> test_sizes = {4000000, 16000000, 64000000};
+    int runs = 5; // Number of benchmark runs to average
+    std::vector<int> hot(2 << 20, 1);
+
+    using Streaming = stm::LargeCopyPolicy<(size_t(8) << 20)>;
+
+    ofstream results_file("benchmark_results_large_copy.csv");
+    results_file << "Size,Type,CopyMeanMs,WorkingSetPassMeanMs\n";
+
+    cout << "Benchmarking reallocation of a full block (memcpy vs non-temporal copy) and a hot 8 MiB pass after it: \n\n";
+
+    for (int size : test_sizes) {
+        std::array<std::array<double, 2>, 2> totals{};
+        for (int i = 0; i < runs; ++i) {
+            const std::array<std::array<double, 2>, 2> t = {
+                benchmark_large_copy<ShiftToMiddleArray<int>>(size, hot),
+                benchmark_large_copy<ShiftToMiddleArray<int, 2, std::allocator<int>, Streaming>>(size, hot),
+            };
+            for (int j = 0; j < 2; ++j) {
+                totals[j][0] += t[j][0] / runs;
+                totals[j][1] += t[j][1] / runs;
+            }
+        }
+
+        const char* names[2] = {"memcpy", "non-temporal"};
+        cout << "Test size: " << size << " (" << static_cast<double>(size) * sizeof(int) / (1 << 20) << " MiB)\n";
+        for (int j = 0; j < 2; ++j) {
+            cout << names[j] << " - copy: " << totals[j][0] << " ms, working-set pass: " << totals[j][1] << " ms\n";
+            results_file << size << "," << names[j] << "," << totals[j][0] << "," << totals[j][1] << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_large_copy.csv\n";
+}
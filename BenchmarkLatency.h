@@ -0,0 +1,11 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include "ShiftToMiddleArray.h"
+#include "IncrementalShiftToMiddleArray.h"
+
+void run_benchmarks_latency(int operations);
+void run_benchmarks_large_copy();
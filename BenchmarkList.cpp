@@ -1,3 +1,4 @@
+#include <array>
 #include <vector>
 #include <list>
 #include <random>
@@ -5,6 +6,8 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <iterator>
+#include <type_traits>
 #include "BenchmarkList.h"
 #include "ShiftToMiddleArray.h"
 
@@ -133,3 +136,84 @@ void run_benchmarks_list(int operations) {
     results_file.close();
     cout << "Results saved to benchmark_results_list.csv\n";
 }
+
+// Batched middle edits (order-book style rebuilds): each step inserts or erases
+// a run of batch_size elements at a random position. Naive applies the run one
+// element at a time, as insert()/delete_at() allowed before range insert/erase.
+enum class EditMode { Range, Naive };
+
+template <typename ContainerType, EditMode Mode = EditMode::Range>
+double benchmark_batched_edits(int size, int steps, int batch_size) {
+    std::mt19937 rng(42); // Fixed seed for reproducibility
+    std::vector<int> batch(static_cast<size_t>(batch_size));
+    for (int k = 0; k < batch_size; ++k) batch[static_cast<size_t>(k)] = k;
+
+    ContainerType container;
+    for (int j = 0; j < size; ++j) container.push_back(j);
+    const size_t floor_size = static_cast<size_t>(size) / 2;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int j = 0; j < steps; ++j) {
+        const size_t n = container.size();
+        const bool grow = n < floor_size + static_cast<size_t>(batch_size) || rng() % 2 == 0;
+        const size_t at = rng() % (grow ? n + 1 : n - static_cast<size_t>(batch_size) + 1);
+        const size_t last = at + static_cast<size_t>(batch_size);
+
+        if constexpr (std::is_same_v<ContainerType, std::list<int>>) {
+            auto it = std::next(container.begin(), static_cast<std::ptrdiff_t>(at));
+            if (grow) container.insert(it, batch.begin(), batch.end());
+            else container.erase(it, std::next(it, batch_size));
+        } else if constexpr (std::is_same_v<ContainerType, std::vector<int>>) {
+            auto it = container.begin() + static_cast<std::ptrdiff_t>(at);
+            if (grow) container.insert(it, batch.begin(), batch.end());
+            else container.erase(it, container.begin() + static_cast<std::ptrdiff_t>(last));
+        } else if constexpr (Mode == EditMode::Naive) {
+            if (grow) {
+                for (int k = 0; k < batch_size; ++k) container.insert(at + static_cast<size_t>(k), batch[static_cast<size_t>(k)]);
+            } else {
+                for (int k = 0; k < batch_size; ++k) container.delete_at(at);
+            }
+        } else {
+            if (grow) container.insert(at, batch.begin(), batch.end());
+            else container.erase(at, last);
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void run_benchmarks_list_batched(int steps) {
+    std::vector<int> test_sizes = {1000, 10000, 100000};
+    std::vector<int> batch_sizes = {8, 64, 512};
+    int runs = 8; // Number of benchmark runs to average
+
+    std::ofstream results_file("benchmark_results_list_batched.csv");
+    results_file << "Size,Batch,Type,TimeMeanMs,TimeStdMs\n";
+
+    std::cout << "Benchmarking batched middle inserts/erases (" << steps << " batches):\n\n";
+
+    for (int size : test_sizes) {
+        for (int batch_size : batch_sizes) {
+            std::array<std::vector<double>, 4> times;
+            for (int i = 0; i < runs; ++i) {
+                times[0].push_back(benchmark_batched_edits<std::vector<int>>(size, steps, batch_size));
+                times[1].push_back(benchmark_batched_edits<std::list<int>>(size, steps, batch_size));
+                times[2].push_back(benchmark_batched_edits<ShiftToMiddleArray<int>, EditMode::Naive>(size, steps, batch_size));
+                times[3].push_back(benchmark_batched_edits<ShiftToMiddleArray<int>>(size, steps, batch_size));
+            }
+
+            const char* names[4] = {"std::vector", "std::list", "STM per element", "STM range"};
+            std::cout << "Container size: " << size << ", batch " << batch_size << "\n";
+            for (int j = 0; j < 4; ++j) {
+                double mean = mean_of(times[j]);
+                std::cout << names[j] << " (avg over " << runs << " runs): " << mean << " ms\n";
+                results_file << size << "," << batch_size << "," << names[j] << "," << mean << "," << stddev_of(times[j], mean) << "\n";
+            }
+            std::cout << "\n";
+        }
+    }
+    results_file.close();
+    std::cout << "Results saved to benchmark_results_list_batched.csv\n";
+}
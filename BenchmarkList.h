@@ -68,3 +68,4 @@ double benchmark_random_operations(int size, int operations, const int iteration
 
 double benchmark_random_operations_list(int size, int operations, const int iterations = 10);
 void run_benchmarks_list(int operations = 40000);
+void run_benchmarks_list_batched(int steps = 2000);
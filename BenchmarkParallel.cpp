@@ -0,0 +1,97 @@
+#include "BenchmarkParallel.h"
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+static double mean_of(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / static_cast<double>(v.size());
+}
+
+template <typename Fn>
+static double time_ms(Fn&& fn) {
+    auto start = chrono::high_resolution_clock::now();
+    fn();
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+// Times the five parallel algorithms over one ShiftToMiddleArray of `size`
+// ints with the given thread count (0: the serial std:: algorithms).
+// Returns {for_each, transform, reduce, inclusive_scan, sort} in ms.
+static std::array<double, 5> benchmark_parallel(int size, int threads) {
+    std::mt19937 rng(42);
+    ShiftToMiddleArray<int> a;
+    for (int i = 0; i < size; ++i) {
+        const int v = static_cast<int>(rng() % 1000000);
+        if (i % 2) a.push_back(v); else a.push_front(v);
+    }
+    stm::parallel::Options options;
+    options.threads = threads;
+    [[maybe_unused]] volatile long long sink = 0;
+    const auto scale = [](int& v) { v = v * 3 + 1; };
+    const auto halve = [](int v) { return v / 2; };
+
+    std::array<double, 5> t{};
+    if (threads == 0) {
+        int* first = a.data();
+        int* last = first + a.size();
+        t[0] = time_ms([&] { std::for_each(first, last, scale); });
+        t[1] = time_ms([&] { std::transform(first, last, first, halve); });
+        t[2] = time_ms([&] { sink = std::accumulate(first, last, 0LL); });
+        t[3] = time_ms([&] { std::inclusive_scan(first, last, first, [](int x, int y) { return x ^ y; }); });
+        std::shuffle(first, last, rng);
+        t[4] = time_ms([&] { std::sort(first, last); });
+    } else {
+        t[0] = time_ms([&] { stm::parallel::for_each(a, scale, options); });
+        t[1] = time_ms([&] { stm::parallel::transform(a, halve, options); });
+        t[2] = time_ms([&] { sink = stm::parallel::reduce(a, 0LL, std::plus<>(), options); });
+        t[3] = time_ms([&] { stm::parallel::inclusive_scan(a, [](int x, int y) { return x ^ y; }, options); });
+        std::shuffle(a.begin(), a.end(), rng);
+        t[4] = time_ms([&] { stm::parallel::sort(a, std::less<>(), options); });
+    }
+    return t;
+}
+
+void run_benchmarks_parallel(int size) {
+    int runs = 5; // Number of benchmark runs to average
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) cores = 1;
+
+    // Serial baseline, then 1, 2, 4, ... threads up to the core count
+    vector<int> thread_counts = {0};
+    for (int t = 1; t < static_cast<int>(cores); t *= 2) thread_counts.push_back(t);
+    thread_counts.push_back(static_cast<int>(cores));
+
+    ofstream results_file("benchmark_results_parallel.csv");
+    results_file << "Size,Threads,Algorithm,TimeMeanMs\n";
+
+    const char* names[5] = {"for_each", "transform", "reduce", "inclusive_scan", "sort"};
+    cout << "Benchmarking parallel algorithms over a ShiftToMiddleArray of " << size << " ints (threads 0 = serial std::): \n\n";
+#ifndef _OPENMP
+    cout << "(built without OpenMP: every thread count runs on one thread)\n\n";
+#endif
+
+    for (int threads : thread_counts) {
+        std::array<std::vector<double>, 5> times;
+        for (int i = 0; i < runs; ++i) {
+            const std::array<double, 5> t = benchmark_parallel(size, threads);
+            for (int j = 0; j < 5; ++j) times[j].push_back(t[j]);
+        }
+
+        cout << "Threads: " << threads << "\n";
+        for (int j = 0; j < 5; ++j) {
+            cout << names[j] << " - " << mean_of(times[j]) << " ms\n";
+            results_file << size << "," << threads << "," << names[j] << "," << mean_of(times[j]) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_parallel.csv\n";
+}
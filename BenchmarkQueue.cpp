@@ -1,8 +1,13 @@
 #include "BenchmarkQueue.h"
 #include <cmath>
+#include <ranges>
 
 using namespace std;
 
+// Opt std::unique_ptr into the memcpy relocation path for the relocation benchmark
+template <typename U, typename D>
+struct stm::is_trivially_relocatable<std::unique_ptr<U, D>> : std::true_type {};
+
 static double mean_of(const std::vector<double>& v) {
     double s = 0.0;
     for (double x : v) s += x;
@@ -39,11 +44,20 @@ double benchmark_queue(int size, int operations, InitFunc init, OperationFunc op
 
 template <typename QueueType>
 void init_queue(QueueType& queue, int test_size) {
-    for (int i = 0; i < test_size; ++i) {
-        queue.push(i);
+    if constexpr (requires { queue.append_range(std::views::iota(0, test_size)); }) {
+        queue.append_range(std::views::iota(0, test_size)); // One growth step instead of test_size pushes
+    } else {
+        for (int i = 0; i < test_size; ++i) {
+            queue.push(i);
+        }
     }
 }
 
+// FIFO traffic wraps around the block instead of being recentered
+struct RingQueuePolicy : stm::DefaultPolicy {
+    static constexpr bool ring_wrap = true;
+};
+
 template <typename QueueType>
 std::array<double, 3> benchmark_all(int test_size, int operations) {
     std::mt19937 rng(42); // Fixed seed for reproducibility
@@ -93,39 +107,46 @@ void run_benchmarks_queue(int operations) {
         std::array<std::vector<double>, 3> stdQueueRuns;
         std::array<std::vector<double>, 3> erBufferRuns;
         std::array<std::vector<double>, 3> stmArrayRuns;
+        std::array<std::vector<double>, 3> stmRingRuns;
         for (int j = 0; j < 3; ++j) {
             stdQueueRuns[j].reserve(runs);
             erBufferRuns[j].reserve(runs);
             stmArrayRuns[j].reserve(runs);
+            stmRingRuns[j].reserve(runs);
         }
 
         for (int i = 0; i < runs; ++i) {
             auto results1 = benchmark_all<std::queue<int>>(size, operations);
             auto results2 = benchmark_all<ExpandingRingBuffer<int>>(size, operations);
             auto results3 = benchmark_all<ShiftToMiddleArray<int>>(size, operations);
+            auto results4 = benchmark_all<ShiftToMiddleArray<int, 2, std::allocator<int>, RingQueuePolicy>>(size, operations);
 
             for (int j = 0; j < 3; ++j) {
                 stdQueueRuns[j].push_back(results1[j]);
                 erBufferRuns[j].push_back(results2[j]);
                 stmArrayRuns[j].push_back(results3[j]);
+                stmRingRuns[j].push_back(results4[j]);
             }
         }
 
-        std::array<double, 3> stdQueue, erBuffer, stmArray;
-        std::array<double, 3> stdQueueStd, erBufferStd, stmArrayStd;
+        std::array<double, 3> stdQueue, erBuffer, stmArray, stmRing;
+        std::array<double, 3> stdQueueStd, erBufferStd, stmArrayStd, stmRingStd;
         for (int j = 0; j < 3; ++j) {
             stdQueue[j] = mean_of(stdQueueRuns[j]);
             erBuffer[j] = mean_of(erBufferRuns[j]);
             stmArray[j] = mean_of(stmArrayRuns[j]);
+            stmRing[j] = mean_of(stmRingRuns[j]);
             stdQueueStd[j] = stddev_of(stdQueueRuns[j], stdQueue[j]);
             erBufferStd[j] = stddev_of(erBufferRuns[j], erBuffer[j]);
             stmArrayStd[j] = stddev_of(stmArrayRuns[j], stmArray[j]);
+            stmRingStd[j] = stddev_of(stmRingRuns[j], stmRing[j]);
         }
 
         cout << "Test size: " << size << "\n";
         cout << "std::queue - Push-heavy: " << stdQueue[0] << " ms, Mixed: " << stdQueue[1] << " ms, Pop-heavy: " << stdQueue[2] << " ms\n";
         cout << "ExpandingRingBuffer - Push-heavy: " << erBuffer[0] << " ms, Mixed: " << erBuffer[1] << " ms, Pop-heavy: " << erBuffer[2] << " ms\n";
         cout << "ShiftToMiddleArray - Push-heavy: " << stmArray[0] << " ms, Mixed: " << stmArray[1] << " ms, Pop-heavy: " << stmArray[2] << " ms\n";
+        cout << "ShiftToMiddleArray (ring) - Push-heavy: " << stmRing[0] << " ms, Mixed: " << stmRing[1] << " ms, Pop-heavy: " << stmRing[2] << " ms\n";
 
         for (int j = 0; j < 3; ++j) {
             double best_time = min(stdQueue[j], erBuffer[j]);
@@ -144,8 +165,375 @@ void run_benchmarks_queue(int operations) {
         results_file << size << ",ShiftToMiddleArray," << stmArray[0] << "," << stmArrayStd[0] << ","
                      << stmArray[1] << "," << stmArrayStd[1] << ","
                      << stmArray[2] << "," << stmArrayStd[2] << "\n";
+        results_file << size << ",ShiftToMiddleArray (ring)," << stmRing[0] << "," << stmRingStd[0] << ","
+                     << stmRing[1] << "," << stmRingStd[1] << ","
+                     << stmRing[2] << "," << stmRingStd[2] << "\n";
     }
 
     results_file.close();
     cout << "Results saved to benchmark_results_queue.csv\n";
 }
+
+// Same payload as std::string, but the move constructor may throw, so relocation
+// has to fall back to copying (the behaviour before move-based relocation).
+struct CopyRelocatedString {
+    std::string s;
+    explicit CopyRelocatedString(std::string v) : s(std::move(v)) {}
+    CopyRelocatedString(const CopyRelocatedString&) = default;
+    CopyRelocatedString(CopyRelocatedString&& o) noexcept(false) : s(std::move(o.s)) {}
+};
+
+// Same payload as std::unique_ptr, without the trivially relocatable opt-in.
+struct MovedPtr {
+    std::unique_ptr<int> p;
+    explicit MovedPtr(std::unique_ptr<int> v) : p(std::move(v)) {}
+};
+
+template <typename T, typename MakeFunc>
+double benchmark_relocation(int size, int operations, MakeFunc make) {
+    // Build the payloads up front so the timed region only measures pushes, pops and relocation
+    std::vector<T> values;
+    values.reserve(size + operations);
+    for (int i = 0; i < size + operations; ++i) values.push_back(make(i));
+
+    ShiftToMiddleArray<T> queue;
+    auto start = chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < size; ++i) {
+        if (i % 4 == 0) queue.push_front(std::move(values[i]));
+        else queue.push_back(std::move(values[i]));
+    }
+    for (int i = size; i < size + operations; ++i) {
+        queue.push_back(std::move(values[i])); // FIFO traffic keeps walking into the tail
+        queue.pop_front();
+    }
+
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+void run_benchmarks_relocation(int operations) {
+    vector<int> test_sizes = {1000, 10000, 100000, 500000};
+    int runs = 8; // Number of benchmark runs to average
+
+    auto make_string = [](int i) { return std::string(48, static_cast<char>('a' + i % 26)); };
+    auto make_ptr = [](int i) { return std::make_unique<int>(i); };
+
+    ofstream results_file("benchmark_results_relocation.csv");
+    results_file << "Size,Type,TimeMeanMs,TimeStdMs\n";
+
+    cout << "Benchmarking relocation of non-trivial element types: \n";
+    cout << "Operations: " << operations << "\n\n";
+
+    for (int size : test_sizes) {
+        std::array<std::vector<double>, 4> times;
+        for (int i = 0; i < runs; ++i) {
+            times[0].push_back(benchmark_relocation<CopyRelocatedString>(size, operations,
+                [&](int v) { return CopyRelocatedString(make_string(v)); }));
+            times[1].push_back(benchmark_relocation<std::string>(size, operations, make_string));
+            times[2].push_back(benchmark_relocation<MovedPtr>(size, operations,
+                [&](int v) { return MovedPtr(make_ptr(v)); }));
+            times[3].push_back(benchmark_relocation<std::unique_ptr<int>>(size, operations, make_ptr));
+        }
+
+        const char* names[4] = {"string (copy relocation)", "string (move relocation)",
+                                "unique_ptr (move relocation)", "unique_ptr (memcpy relocation)"};
+        cout << "Test size: " << size << "\n";
+        for (int j = 0; j < 4; ++j) {
+            double mean = mean_of(times[j]);
+            cout << names[j] << ": " << mean << " ms\n";
+            results_file << size << "," << names[j] << "," << mean << "," << stddev_of(times[j], mean) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_relocation.csv\n";
+}
+
+// One "request": many short-lived queues, each filled, churned and dropped.
+template <typename QueueType, typename MakeQueue>
+void churn_queues(int queues, int size, int operations, MakeQueue make) {
+    for (int q = 0; q < queues; ++q) {
+        QueueType queue = make();
+        for (int i = 0; i < size; ++i) queue.push_back(i);
+        for (int i = 0; i < operations; ++i) {
+            queue.push_back(i);
+            queue.pop_front();
+        }
+    }
+}
+
+template <typename RequestFunc>
+double benchmark_requests(int requests, RequestFunc request) {
+    auto start = chrono::high_resolution_clock::now();
+    for (int r = 0; r < requests; ++r) request();
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+void run_benchmarks_arena(int operations) {
+    vector<int> test_sizes = {8, 64, 512, 4096};
+    const int queues_per_request = 1000;
+    const int requests = 20;
+    int runs = 8; // Number of benchmark runs to average
+
+    // Backing store for the per-request arena, reused across requests
+    std::vector<std::byte> arena_buffer(64 << 20);
+
+    ofstream results_file("benchmark_results_arena.csv");
+    results_file << "Size,Type,TimeMeanMs,TimeStdMs\n";
+
+    cout << "Benchmarking malloc-backed vs arena-backed queue churn: \n";
+    cout << "Queues per request: " << queues_per_request << ", requests: " << requests
+         << ", operations per queue: " << operations / queues_per_request << "\n\n";
+
+    const int ops = operations / queues_per_request;
+    for (int size : test_sizes) {
+        std::array<std::vector<double>, 3> times;
+        for (int i = 0; i < runs; ++i) {
+            times[0].push_back(benchmark_requests(requests, [&] {
+                churn_queues<ShiftToMiddleArray<int>>(queues_per_request, size, ops,
+                    [] { return ShiftToMiddleArray<int>(); });
+            }));
+            times[1].push_back(benchmark_requests(requests, [&] {
+                churn_queues<stm::pmr::ShiftToMiddleArray<int>>(queues_per_request, size, ops,
+                    [] { return stm::pmr::ShiftToMiddleArray<int>(std::pmr::new_delete_resource()); });
+            }));
+            times[2].push_back(benchmark_requests(requests, [&] {
+                std::pmr::monotonic_buffer_resource arena(arena_buffer.data(), arena_buffer.size());
+                churn_queues<stm::pmr::ShiftToMiddleArray<int>>(queues_per_request, size, ops,
+                    [&] { return stm::pmr::ShiftToMiddleArray<int>(&arena); });
+            }));
+        }
+
+        const char* names[3] = {"std::allocator", "pmr new_delete_resource", "pmr monotonic_buffer_resource"};
+        cout << "Test size: " << size << "\n";
+        for (int j = 0; j < 3; ++j) {
+            double mean = mean_of(times[j]);
+            cout << names[j] << ": " << mean << " ms\n";
+            results_file << size << "," << names[j] << "," << mean << "," << stddev_of(times[j], mean) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_arena.csv\n";
+}
+
+#ifdef __linux__
+// Grows a queue from empty to `size` elements, alternating ends, and reports the
+// total time and the single slowest push (the growth stall).
+template <typename QueueType>
+std::array<double, 2> benchmark_growth_stall(int size) {
+    QueueType queue;
+    double worst = 0.0;
+    auto start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < size; ++i) {
+        auto before = chrono::high_resolution_clock::now();
+        if (i % 2 == 0) queue.push_back(i);
+        else queue.push_front(i);
+        auto after = chrono::high_resolution_clock::now();
+        worst = std::max(worst, chrono::duration<double, milli>(after - before).count());
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return {chrono::duration<double, milli>(end - start).count(), worst};
+}
+
+void run_benchmarks_vm_growth() {
+    vector<int> test_sizes = {1 << 20, 1 << 23, 1 << 25};
+    int runs = 4; // Number of benchmark runs to average
+
+    ofstream results_file("benchmark_results_vm_growth.csv");
+    results_file << "Size,Type,TotalMeanMs,WorstPushMeanMs\n";
+
+    cout << "Benchmarking growth stalls, malloc-backed vs virtual-memory-backed: \n\n";
+
+    for (int size : test_sizes) {
+        std::array<std::vector<double>, 2> totals, worst;
+        for (int i = 0; i < runs; ++i) {
+            auto heap = benchmark_growth_stall<ShiftToMiddleArray<int>>(size);
+            auto vm = benchmark_growth_stall<ShiftToMiddleArray<int, 2, VirtualMemoryAllocator<int>>>(size);
+            totals[0].push_back(heap[0]); worst[0].push_back(heap[1]);
+            totals[1].push_back(vm[0]); worst[1].push_back(vm[1]);
+        }
+
+        const char* names[2] = {"std::allocator", "VirtualMemoryAllocator"};
+        cout << "Test size: " << size << "\n";
+        for (int j = 0; j < 2; ++j) {
+            cout << names[j] << " - total: " << mean_of(totals[j]) << " ms, worst push: " << mean_of(worst[j]) << " ms\n";
+            results_file << size << "," << names[j] << "," << mean_of(totals[j]) << "," << mean_of(worst[j]) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_vm_growth.csv\n";
+}
+#endif
+
+struct CenteringStatsPolicy : stm::DefaultPolicy {
+    static constexpr unsigned drift_threshold = 0;
+    static constexpr bool collect_stats = true;
+};
+
+struct DriftStatsPolicy : stm::DefaultPolicy {
+    static constexpr bool collect_stats = true;
+};
+
+// Steady FIFO at a fixed size: every recentering is caused by the tail chasing
+// the end of the block. Returns {time ms, bytes moved, shifts}.
+template <typename QueueType>
+std::array<double, 3> benchmark_recentering(int size, int operations) {
+    QueueType queue(static_cast<size_t>(size) * 4);
+    for (int i = 0; i < size; ++i) queue.push_back(i);
+    queue.reset_stats();
+
+    auto start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < operations; ++i) {
+        queue.push_back(i);
+        queue.pop_front();
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return {chrono::duration<double, milli>(end - start).count(),
+            static_cast<double>(queue.stats().bytes_moved), static_cast<double>(queue.stats().shifts)};
+}
+
+void run_benchmarks_recentering(int operations) {
+    vector<int> test_sizes = {100, 1000, 10000, 100000};
+    int runs = 10; // Number of benchmark runs to average
+
+    ofstream results_file("benchmark_results_recentering.csv");
+    results_file << "Size,Type,TimeMeanMs,BytesMoved,Shifts\n";
+
+    cout << "Benchmarking recentering under FIFO drift (centered vs drift-aware): \n\n";
+
+    for (int size : test_sizes) {
+        std::array<std::vector<double>, 2> times;
+        std::array<std::array<double, 3>, 2> last;
+        for (int i = 0; i < runs; ++i) {
+            last[0] = benchmark_recentering<ShiftToMiddleArray<int, 2, std::allocator<int>, CenteringStatsPolicy>>(size, operations);
+            last[1] = benchmark_recentering<ShiftToMiddleArray<int, 2, std::allocator<int>, DriftStatsPolicy>>(size, operations);
+            times[0].push_back(last[0][0]);
+            times[1].push_back(last[1][0]);
+        }
+
+        const char* names[2] = {"Centered", "DriftAware"};
+        cout << "Test size: " << size << "\n";
+        for (int j = 0; j < 2; ++j) {
+            cout << names[j] << " - time: " << mean_of(times[j]) << " ms, bytes moved: " << last[j][1]
+                 << ", shifts: " << last[j][2] << "\n";
+            results_file << size << "," << names[j] << "," << mean_of(times[j]) << "," << last[j][1] << "," << last[j][2] << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_recentering.csv\n";
+}
+
+// Cancellation sweep: remove every order whose id hits the cancelled share,
+// once, from a queue of `size` orders. Returns the time in ms.
+template <typename QueueType>
+double benchmark_sweep(int size, int cancel_percent) {
+    std::mt19937 rng(42); // Fixed seed for reproducibility
+    QueueType queue;
+    for (int i = 0; i < size; ++i) queue.push_back(static_cast<int>(rng() % 100));
+    const auto cancelled = [cancel_percent](int v) { return v < cancel_percent; };
+
+    auto start = chrono::high_resolution_clock::now();
+    if constexpr (requires { queue.erase_if(cancelled); }) {
+        queue.erase_if(cancelled);
+    } else {
+        queue.erase(std::remove_if(queue.begin(), queue.end(), cancelled), queue.end());
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+void run_benchmarks_sweep() {
+    vector<int> test_sizes = {100000, 1000000, 4000000};
+    vector<int> cancel_percents = {1, 10, 50};
+    int runs = 8; // Number of benchmark runs to average
+
+    ofstream results_file("benchmark_results_sweep.csv");
+    results_file << "Size,CancelPercent,Type,TimeMeanMs,TimeStdMs\n";
+
+    cout << "Benchmarking cancellation sweeps (erase_if vs erase/remove_if): \n\n";
+
+    for (int size : test_sizes) {
+        for (int percent : cancel_percents) {
+            std::array<std::vector<double>, 3> times;
+            for (int i = 0; i < runs; ++i) {
+                times[0].push_back(benchmark_sweep<std::vector<int>>(size, percent));
+                times[1].push_back(benchmark_sweep<std::deque<int>>(size, percent));
+                times[2].push_back(benchmark_sweep<ShiftToMiddleArray<int>>(size, percent));
+            }
+
+            const char* names[3] = {"std::vector", "std::deque", "ShiftToMiddleArray"};
+            cout << "Test size: " << size << ", " << percent << "% cancelled\n";
+            for (int j = 0; j < 3; ++j) {
+                double mean = mean_of(times[j]);
+                cout << names[j] << " (avg over " << runs << " runs): " << mean << " ms\n";
+                results_file << size << "," << percent << "," << names[j] << "," << mean << "," << stddev_of(times[j], mean) << "\n";
+            }
+            cout << "\n";
+        }
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_sweep.csv\n";
+}
+
+// Many short-lived tiny queues (per-connection style): build `count` queues,
+// push `depth` elements into each, drain them. Returns the time in ms.
+template <typename QueueType>
+double benchmark_small_queues(int count, int depth) {
+    auto start = chrono::high_resolution_clock::now();
+    std::vector<QueueType> queues(static_cast<size_t>(count));
+    long long sum = 0;
+    for (auto& q : queues) {
+        for (int i = 0; i < depth; ++i) q.push_back(i);
+    }
+    for (auto& q : queues) {
+        while (!q.empty()) {
+            sum += q.front();
+            q.pop_front();
+        }
+    }
+    queues.clear();
+    auto end = chrono::high_resolution_clock::now();
+    if (sum < 0) cout << sum;  // keep the loop observable
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+void run_benchmarks_small_queues(int count) {
+    vector<int> depths = {1, 4, 8, 32};
+    int runs = 8; // Number of benchmark runs to average
+
+    ofstream results_file("benchmark_results_small_queues.csv");
+    results_file << "Depth,Type,TimeMeanMs,TimeStdMs\n";
+
+    cout << "Benchmarking " << count << " tiny queues (heap vs inline storage): \n\n";
+
+    for (int depth : depths) {
+        std::array<std::vector<double>, 3> times;
+        for (int i = 0; i < runs; ++i) {
+            times[0].push_back(benchmark_small_queues<std::deque<int>>(count, depth));
+            times[1].push_back(benchmark_small_queues<ShiftToMiddleArray<int>>(count, depth));
+            times[2].push_back(benchmark_small_queues<SmallShiftToMiddleArray<int, 8>>(count, depth));
+        }
+
+        const char* names[3] = {"std::deque", "ShiftToMiddleArray", "SmallShiftToMiddleArray<8>"};
+        cout << "Depth: " << depth << "\n";
+        for (int j = 0; j < 3; ++j) {
+            double mean = mean_of(times[j]);
+            cout << names[j] << " (avg over " << runs << " runs): " << mean << " ms\n";
+            results_file << depth << "," << names[j] << "," << mean << "," << stddev_of(times[j], mean) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_small_queues.csv\n";
+}
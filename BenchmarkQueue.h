@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <array>
 #include <deque>
 #include <queue>
@@ -7,8 +8,22 @@
 #include <chrono>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <string>
 #include <omp.h>
 #include "ShiftToMiddleArray.h"
 #include "ExpandingRingBuffer.h"
+#ifdef __linux__
+#include "VirtualMemoryAllocator.h"
+#endif
 
 void run_benchmarks_queue(int operations);
+void run_benchmarks_relocation(int operations);
+void run_benchmarks_arena(int operations);
+void run_benchmarks_recentering(int operations);
+void run_benchmarks_sweep();
+void run_benchmarks_small_queues(int count);
+#ifdef __linux__
+void run_benchmarks_vm_growth();
+#endif
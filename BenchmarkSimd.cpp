@@ -0,0 +1,99 @@
+#include "BenchmarkSimd.h"
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+using namespace std;
+
+static double mean_of(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / static_cast<double>(v.size());
+}
+
+enum class Query { Find, Count, Sum, Min, LowerBound };
+
+// The std:: algorithm over any container's iterators
+template <typename ContainerType>
+long long query_std(const ContainerType& c, Query q, int value) {
+    switch (q) {
+        case Query::Find: return std::find(c.begin(), c.end(), value) - c.begin();
+        case Query::Count: return std::count(c.begin(), c.end(), value);
+        case Query::Sum: return std::accumulate(c.begin(), c.end(), 0);
+        case Query::Min: return *std::min_element(c.begin(), c.end());
+        case Query::LowerBound: return std::lower_bound(c.begin(), c.end(), value) - c.begin();
+    }
+    return 0;
+}
+
+// The member kernels
+long long query_stm(const ShiftToMiddleArray<int>& c, Query q, int value) {
+    switch (q) {
+        case Query::Find: return c.find(value) - c.begin();
+        case Query::Count: return static_cast<long long>(c.count(value));
+        case Query::Sum: return c.sum();
+        case Query::Min: return c.min();
+        case Query::LowerBound: return c.lower_bound(value) - c.begin();
+    }
+    return 0;
+}
+
+// Runs the query enough times to touch ~100M elements in total (or 1M lookups
+// for lower_bound), with values that miss for find; returns ms.
+template <typename Fn>
+double time_queries(int size, Query q, Fn&& fn) {
+    const int reps = q == Query::LowerBound ? 1000000 : std::max(1, 100000000 / size);
+    [[maybe_unused]] volatile long long sink = 0;
+    auto start = chrono::high_resolution_clock::now();
+    for (int r = 0; r < reps; ++r) {
+        const int value = q == Query::LowerBound ? static_cast<int>(static_cast<long long>(r) * 7919 % (2 * size)) : -1 - (r & 1);
+        sink = sink + fn(q, value);
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+void run_benchmarks_simd() {
+    vector<int> test_sizes = {1000, 100000, 1000000};
+    int runs = 5; // Number of benchmark runs to average
+    const Query queries[5] = {Query::Find, Query::Count, Query::Sum, Query::Min, Query::LowerBound};
+    const char* query_names[5] = {"find (miss)", "count", "sum", "min", "lower_bound"};
+
+    ofstream results_file("benchmark_results_simd.csv");
+    results_file << "Size,Query,Type,TimeMeanMs\n";
+
+    cout << "Benchmarking search and reduction kernels against std:: algorithms (~100M elements scanned, or 1M lower_bound lookups): \n\n";
+
+    for (int size : test_sizes) {
+        // Sorted even values, so lower_bound has something to do; pushed at
+        // both ends so the window sits in the middle of the block
+        vector<int> v(static_cast<size_t>(size));
+        for (int i = 0; i < size; ++i) v[static_cast<size_t>(i)] = 2 * i;
+        deque<int> d(v.begin(), v.end());
+        ShiftToMiddleArray<int> stm;
+        for (int i = size / 2; i < size; ++i) stm.push_back(v[static_cast<size_t>(i)]);
+        for (int i = size / 2; i-- > 0;) stm.push_front(v[static_cast<size_t>(i)]);
+
+        cout << "Test size: " << size << "\n";
+        for (int q = 0; q < 5; ++q) {
+            std::array<std::vector<double>, 4> times;
+            for (int i = 0; i < runs; ++i) {
+                times[0].push_back(time_queries(size, queries[q], [&](Query qq, int x) { return query_std(v, qq, x); }));
+                times[1].push_back(time_queries(size, queries[q], [&](Query qq, int x) { return query_std(d, qq, x); }));
+                times[2].push_back(time_queries(size, queries[q], [&](Query qq, int x) { return query_std(stm, qq, x); }));
+                times[3].push_back(time_queries(size, queries[q], [&](Query qq, int x) { return query_stm(stm, qq, x); }));
+            }
+
+            const char* names[4] = {"std::vector + std::", "std::deque + std::", "ShiftToMiddleArray + std::", "ShiftToMiddleArray kernels"};
+            cout << query_names[q] << ":\n";
+            for (int j = 0; j < 4; ++j) {
+                cout << "  " << names[j] << " - " << mean_of(times[j]) << " ms\n";
+                results_file << size << "," << query_names[q] << "," << names[j] << "," << mean_of(times[j]) << "\n";
+            }
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_simd.csv\n";
+}
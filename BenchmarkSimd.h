@@ -0,0 +1,9 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include "ShiftToMiddleArray.h"
+
+void run_benchmarks_simd();
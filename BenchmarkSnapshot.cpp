@@ -0,0 +1,123 @@
+#include "BenchmarkSnapshot.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+static double mean_of(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / static_cast<double>(v.size());
+}
+
+struct SnapshotResult {
+    double writer_mops;
+    double snapshots_per_sec;
+};
+
+// The writer keeps `backlog` elements queued and does `operations` push_back +
+// pop_front pairs while `readers` threads take snapshots back to back.
+
+// Baseline: the writer locks a mutex per operation, readers lock it and copy
+// the whole array with the copy constructor
+static SnapshotResult benchmark_locked_copy(int operations, int backlog, int readers) {
+    std::mutex m;
+    ShiftToMiddleArray<std::uint64_t> a;
+    for (int i = 0; i < backlog; ++i) a.push_back(static_cast<std::uint64_t>(i));
+    std::atomic<bool> started{false}, done{false};
+    std::atomic<size_t> snapshots{0};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            while (!started.load(std::memory_order_acquire)) std::this_thread::yield();
+            size_t n = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> lock(m);
+                ShiftToMiddleArray<std::uint64_t> copy(a);
+                n += copy.back() - copy.front() + 1 == copy.size();
+            }
+            snapshots.fetch_add(n, std::memory_order_relaxed);
+        });
+    }
+    auto start = chrono::steady_clock::now();
+    started.store(true, std::memory_order_release);
+    for (int i = 0; i < operations; ++i) {
+        std::lock_guard<std::mutex> lock(m);
+        a.push_back(static_cast<std::uint64_t>(backlog + i));
+        a.pop_front();
+    }
+    auto end = chrono::steady_clock::now();
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+    const double seconds = chrono::duration<double>(end - start).count();
+    return {operations / seconds / 1e6, snapshots.load() / seconds};
+}
+
+static SnapshotResult benchmark_snapshot_array(int operations, int backlog, int readers) {
+    SnapshotShiftToMiddleArray<std::uint64_t> a;
+    for (int i = 0; i < backlog; ++i) a.push_back(static_cast<std::uint64_t>(i));
+    std::atomic<bool> started{false}, done{false};
+    std::atomic<size_t> snapshots{0};
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            while (!started.load(std::memory_order_acquire)) std::this_thread::yield();
+            size_t n = 0;
+            std::vector<std::uint64_t> snap;
+            while (!done.load(std::memory_order_acquire)) {
+                a.snapshot_into(snap);
+                n += snap.back() - snap.front() + 1 == snap.size();
+            }
+            snapshots.fetch_add(n, std::memory_order_relaxed);
+        });
+    }
+    auto start = chrono::steady_clock::now();
+    started.store(true, std::memory_order_release);
+    for (int i = 0; i < operations; ++i) {
+        a.push_back(static_cast<std::uint64_t>(backlog + i));
+        a.pop_front();
+    }
+    auto end = chrono::steady_clock::now();
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+    const double seconds = chrono::duration<double>(end - start).count();
+    return {operations / seconds / 1e6, snapshots.load() / seconds};
+}
+
+void run_benchmarks_snapshot(int operations) {
+    int runs = 5; // Number of benchmark runs to average
+    const int readers = 2;
+    vector<int> backlogs = {1000, 100000};
+
+    ofstream results_file("benchmark_results_snapshot.csv");
+    results_file << "Operations,Backlog,Readers,Type,WriterMopsPerSecMean,SnapshotsPerSecMean\n";
+
+    cout << "Benchmarking " << operations << " writer push_back + pop_front pairs while " << readers << " readers take snapshots: \n\n";
+
+    const char* names[2] = {"mutex + copy constructor", "SnapshotShiftToMiddleArray"};
+    for (int backlog : backlogs) {
+        std::array<std::vector<double>, 2> writer;
+        std::array<std::vector<double>, 2> snapshots;
+        for (int i = 0; i < runs; ++i) {
+            const SnapshotResult locked = benchmark_locked_copy(operations, backlog, readers);
+            const SnapshotResult lockless = benchmark_snapshot_array(operations, backlog, readers);
+            writer[0].push_back(locked.writer_mops);
+            snapshots[0].push_back(locked.snapshots_per_sec);
+            writer[1].push_back(lockless.writer_mops);
+            snapshots[1].push_back(lockless.snapshots_per_sec);
+        }
+
+        cout << "Backlog: " << backlog << "\n";
+        for (int j = 0; j < 2; ++j) {
+            cout << names[j] << " - writer " << mean_of(writer[j]) << " Mops/s, " << mean_of(snapshots[j]) << " snapshots/s\n";
+            results_file << operations << "," << backlog << "," << readers << "," << names[j] << "," << mean_of(writer[j]) << "," << mean_of(snapshots[j]) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_snapshot.csv\n";
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include "SnapshotShiftToMiddleArray.h"
+
+void run_benchmarks_snapshot(int operations);
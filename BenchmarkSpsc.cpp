@@ -0,0 +1,140 @@
+#include "BenchmarkSpsc.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+
+using namespace std;
+
+static double mean_of(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / static_cast<double>(v.size());
+}
+
+static int64_t now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The hand-offs under test. Each moves int64 timestamps from one producer to
+// one consumer: push(v) / push_n(span) on the producer side, pop_n(fn, max) on
+// the consumer side (fn called per element, returns how many it took).
+
+struct SpscHandoff {
+    SpscShiftToMiddleQueue<int64_t> q;
+    void push(int64_t v) { q.push_back(v); }
+    void push_n(std::span<const int64_t> s) { q.push_back_n(s.begin(), s.size()); }
+    template <typename Fn>
+    size_t pop_n(Fn&& fn, size_t max) {
+        std::span<int64_t> s = q.front_span();
+        const size_t n = std::min(max, s.size());
+        for (size_t i = 0; i < n; ++i) fn(s[i]);
+        q.pop_front_n(n);
+        return n;
+    }
+};
+
+template <typename Queue>
+struct MutexHandoff {
+    std::mutex m;
+    Queue q;
+    void push(int64_t v) {
+        std::lock_guard<std::mutex> lock(m);
+        q.push_back(v);
+    }
+    void push_n(std::span<const int64_t> s) {
+        std::lock_guard<std::mutex> lock(m);
+        for (int64_t v : s) q.push_back(v);
+    }
+    template <typename Fn>
+    size_t pop_n(Fn&& fn, size_t max) {
+        std::lock_guard<std::mutex> lock(m);
+        size_t n = 0;
+        for (; n < max && !q.empty(); ++n) {
+            fn(q.front());
+            q.pop_front();
+        }
+        return n;
+    }
+};
+
+// Sends `items` timestamps in batches of `batch` (1: one push/pop per element)
+// and records the hand-off latency of every 64th one.
+// Returns {throughput in Mitems/s, p50 ns, p99 ns}.
+template <typename Handoff>
+std::array<double, 3> benchmark_spsc(int items, size_t batch) {
+    Handoff h;
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(items) / 64 + 1);
+
+    auto start = chrono::steady_clock::now();
+    std::thread producer([&] {
+        std::vector<int64_t> buffer(batch);
+        for (int sent = 0; sent < items;) {
+            const size_t n = std::min(batch, static_cast<size_t>(items - sent));
+            if (n == 1) {
+                h.push(now_ns());
+            } else {
+                std::fill_n(buffer.begin(), n, now_ns());
+                h.push_n(std::span<const int64_t>(buffer.data(), n));
+            }
+            sent += static_cast<int>(n);
+        }
+    });
+
+    int received = 0;
+    while (received < items) {
+        const size_t n = h.pop_n([&](int64_t stamp) {
+            if (received++ % 64 == 0) latencies.push_back(static_cast<double>(now_ns() - stamp));
+        }, std::max<size_t>(batch, 1));
+        if (n == 0) std::this_thread::yield();  // the producer may share our core
+    }
+    auto end = chrono::steady_clock::now();
+    producer.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto at = [&](double q) {
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(q * static_cast<double>(latencies.size())))];
+    };
+    const double seconds = chrono::duration<double>(end - start).count();
+    return {items / seconds / 1e6, at(0.50), at(0.99)};
+}
+
+void run_benchmarks_spsc(int items) {
+    int runs = 5; // Number of benchmark runs to average
+    vector<size_t> batches = {1, 64};
+
+    ofstream results_file("benchmark_results_spsc.csv");
+    results_file << "Items,Batch,Type,MitemsPerSecMean,P50NsMean,P99NsMean\n";
+
+    cout << "Benchmarking two-thread hand-off of " << items << " items (one producer, one consumer): \n\n";
+
+    const char* names[3] = {"SpscShiftToMiddleQueue", "mutex + ShiftToMiddleArray", "mutex + std::deque"};
+    for (size_t batch : batches) {
+        std::array<std::array<std::vector<double>, 3>, 3> results;
+        for (int i = 0; i < runs; ++i) {
+            const std::array<std::array<double, 3>, 3> r = {
+                benchmark_spsc<SpscHandoff>(items, batch),
+                benchmark_spsc<MutexHandoff<ShiftToMiddleArray<int64_t>>>(items, batch),
+                benchmark_spsc<MutexHandoff<std::deque<int64_t>>>(items, batch),
+            };
+            for (int j = 0; j < 3; ++j) {
+                for (int k = 0; k < 3; ++k) results[j][k].push_back(r[j][k]);
+            }
+        }
+
+        cout << "Batch: " << batch << "\n";
+        for (int j = 0; j < 3; ++j) {
+            cout << names[j] << " - " << mean_of(results[j][0]) << " Mitems/s, p50: " << mean_of(results[j][1])
+                 << " ns, p99: " << mean_of(results[j][2]) << " ns\n";
+            results_file << items << "," << batch << "," << names[j] << "," << mean_of(results[j][0]) << ","
+                         << mean_of(results[j][1]) << "," << mean_of(results[j][2]) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_spsc.csv\n";
+}
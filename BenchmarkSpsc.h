@@ -0,0 +1,10 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include "ShiftToMiddleArray.h"
+#include "SpscShiftToMiddleQueue.h"
+
+void run_benchmarks_spsc(int items);
@@ -0,0 +1,205 @@
+#include "BenchmarkWorkStealing.h"
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+static double mean_of(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / static_cast<double>(v.size());
+}
+
+template <typename Fn>
+static double time_ms(Fn&& fn) {
+    auto start = chrono::high_resolution_clock::now();
+    fn();
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+// The baseline scheduler: every task goes through one ShiftToMiddleArray under
+// a mutex, which workers and waiting threads pop from the front. Same TaskGroup
+// interface and helping wait() as WorkStealingPool.
+class LockedQueuePool {
+    struct Task {
+        std::function<void()> fn;
+        std::atomic<size_t>* pending;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    ShiftToMiddleArray<Task*> queue_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+
+    Task* try_take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) return nullptr;
+        Task* task = queue_.front();
+        queue_.pop_front();
+        return task;
+    }
+
+    static void execute(Task* task) {
+        task->fn();
+        task->pending->fetch_sub(1, std::memory_order_acq_rel);
+        delete task;
+    }
+
+public:
+    class TaskGroup {
+        LockedQueuePool& pool_;
+        std::atomic<size_t> pending_{0};
+
+    public:
+        explicit TaskGroup(LockedQueuePool& pool) : pool_(pool) {}
+
+        template <typename F>
+        void run(F&& f) {
+            pending_.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(pool_.mutex_);
+                pool_.queue_.push_back(new Task{std::function<void()>(std::forward<F>(f)), &pending_});
+            }
+            pool_.ready_.notify_one();
+        }
+
+        void wait() {
+            while (pending_.load(std::memory_order_acquire) != 0) {
+                if (Task* task = pool_.try_take()) execute(task);
+                else std::this_thread::yield();
+            }
+        }
+    };
+
+    explicit LockedQueuePool(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this] {
+                for (;;) {
+                    Task* task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        ready_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+                        if (stop_) return;
+                        task = queue_.front();
+                        queue_.pop_front();
+                    }
+                    execute(task);
+                }
+            });
+        }
+    }
+
+    ~LockedQueuePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        ready_.notify_all();
+        for (std::thread& t : threads_) t.join();
+    }
+};
+
+// Fork/join kernels: one task per recursive call above the cutoff
+
+template <typename Pool>
+long long fib(Pool& pool, int n) {
+    if (n < 12) return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+    long long left = 0;
+    typename Pool::TaskGroup group(pool);
+    group.run([&] { left = fib(pool, n - 1); });
+    const long long right = fib(pool, n - 2);
+    group.wait();
+    return left + right;
+}
+
+template <typename Pool>
+void quicksort(Pool& pool, int* first, int* last) {
+    if (last - first < 4096) {
+        std::sort(first, last);
+        return;
+    }
+    const int pivot = first[(last - first) / 2];
+    int* mid1 = std::partition(first, last, [pivot](int v) { return v < pivot; });
+    int* mid2 = std::partition(mid1, last, [pivot](int v) { return !(pivot < v); });
+    typename Pool::TaskGroup group(pool);
+    group.run([&] { quicksort(pool, first, mid1); });
+    quicksort(pool, mid2, last);
+    group.wait();
+}
+
+// Runs fn as a task, so that the computation starts on a worker, and waits
+template <typename Pool, typename Fn>
+void run_on(Pool& pool, Fn&& fn) {
+    typename Pool::TaskGroup group(pool);
+    group.run(std::forward<Fn>(fn));
+    group.wait();
+}
+
+// Returns {fib ms, quicksort ms}
+template <typename Pool>
+std::array<double, 2> benchmark_fork_join(Pool& pool, int fib_n, const std::vector<int>& input) {
+    [[maybe_unused]] volatile long long sink = 0;
+    std::vector<int> data = input;
+    std::array<double, 2> t{};
+    t[0] = time_ms([&] { run_on(pool, [&] { sink = fib(pool, fib_n); }); });
+    t[1] = time_ms([&] { run_on(pool, [&] { quicksort(pool, data.data(), data.data() + data.size()); }); });
+    if (!std::is_sorted(data.begin(), data.end())) cout << "quicksort failed\n";
+    return t;
+}
+
+void run_benchmarks_work_stealing() {
+    int runs = 5; // Number of benchmark runs to average
+    const int fib_n = 32;
+    const size_t sort_size = 4000000;
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) cores = 1;
+
+    std::mt19937 rng(42);
+    std::vector<int> input(sort_size);
+    for (int& v : input) v = static_cast<int>(rng());
+
+    // 1, 2, 4, ... workers, at least up to 4
+    vector<size_t> thread_counts;
+    for (size_t t = 1; t <= std::max<size_t>(cores, 4); t *= 2) thread_counts.push_back(t);
+
+    ofstream results_file("benchmark_results_work_stealing.csv");
+    results_file << "Threads,Type,FibMeanMs,QuicksortMeanMs\n";
+
+    cout << "Benchmarking fork/join (fib(" << fib_n << "), quicksort of " << sort_size << " ints): work stealing vs one locked queue\n\n";
+
+    const char* names[2] = {"WorkStealingPool", "locked global queue"};
+    for (size_t threads : thread_counts) {
+        std::array<std::array<std::vector<double>, 2>, 2> results;
+        for (int i = 0; i < runs; ++i) {
+            std::array<std::array<double, 2>, 2> r;
+            {
+                WorkStealingPool pool(threads);
+                r[0] = benchmark_fork_join(pool, fib_n, input);
+            }
+            {
+                LockedQueuePool pool(threads);
+                r[1] = benchmark_fork_join(pool, fib_n, input);
+            }
+            for (int j = 0; j < 2; ++j) {
+                for (int k = 0; k < 2; ++k) results[j][k].push_back(r[j][k]);
+            }
+        }
+
+        cout << "Threads: " << threads << "\n";
+        for (int j = 0; j < 2; ++j) {
+            cout << names[j] << " - fib: " << mean_of(results[j][0]) << " ms, quicksort: " << mean_of(results[j][1]) << " ms\n";
+            results_file << threads << "," << names[j] << "," << mean_of(results[j][0]) << "," << mean_of(results[j][1]) << "\n";
+        }
+        cout << "\n";
+    }
+
+    results_file.close();
+    cout << "Results saved to benchmark_results_work_stealing.csv\n";
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include "ShiftToMiddleArray.h"
+#include "WorkStealingPool.h"
+
+void run_benchmarks_work_stealing();
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstring>      // std::memcpy
+#include <functional>   // std::less, std::less_equal
+#include <memory>       // std::addressof, std::allocator, std::allocator_traits
+#include <type_traits>  // std::is_nothrow_move_constructible_v, std::is_copy_constructible_v
+#include <utility>      // std::as_const, std::move, std::swap
+#include <algorithm>    // std::min, std::max
+
+#include "ShiftToMiddleArray.h"
+
+// Shift-to-middle array whose growth and recentering are spread over the
+// following operations instead of being done inside the one push that hits an
+// edge.
+//
+// When an edge is reached a new block is allocated (larger when the array is
+// past the recenter limit, same size otherwise, like ShiftToMiddleArray) and the
+// live window is given its final, centered position in it, but the elements stay
+// in the old block. Every later push or pop then migrates a bounded number of
+// them (`step`); the step is chosen so the migration always completes before the
+// new block can run out of slack on either side. Until then the old block is
+// kept alive and element access picks the right block with a single range check.
+//
+// The worst-case work per push is therefore one allocation plus `step` (about 3)
+// element relocations, independent of size(). Operations that need the whole
+// window in one block, such as data(), finish the migration first.
+//
+// Of the Policy knobs (see stm::DefaultPolicy) growth and bounds_check
+// apply; elements are always destroyed on removal and the block is always centered.
+template <typename T, size_t ResizeMult = 2, typename Allocator = std::allocator<T>, typename Policy = stm::DefaultPolicy>
+class IncrementalShiftToMiddleArray {
+
+public:
+    using allocator_type = Allocator;
+    using policy_type = Policy;
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    [[no_unique_address]] Allocator alloc_;
+    T* data_;
+    size_t head_, tail_, capacity_;
+
+    // Migration state. Positions are in the coordinates of data_; the elements at
+    // [pending_lo_, pending_hi_) still live in old_, at index (position - shift_).
+    T* old_ = nullptr;
+    size_t old_capacity_ = 0;
+    size_t pending_lo_ = 0, pending_hi_ = 0;
+    size_t shift_ = 0;
+    size_t step_ = 0;
+
+    static void check(bool ok, const char* msg) { stm::detail::check<Policy::bounds_check>(ok, msg); }
+
+    bool pending(size_t pos) const noexcept { return pos - pending_lo_ < pending_hi_ - pending_lo_; }
+
+    T* slot(size_t pos) noexcept { return pending(pos) ? old_ + (pos - shift_) : data_ + pos; }
+    const T* slot(size_t pos) const noexcept { return pending(pos) ? old_ + (pos - shift_) : data_ + pos; }
+
+    // Whether p points into the block a pending migration is draining, which
+    // begin_migration() frees
+    bool in_old_block(const T* p) const noexcept {
+        return old_ && std::less_equal<const T*>()(old_, p) && std::less<const T*>()(p, old_ + old_capacity_);
+    }
+
+    void relocate(T* from, size_t n, T* to) {
+        if constexpr (stm::is_trivially_relocatable_v<T>) {
+            if (n) std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        } else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            for (size_t i = 0; i < n; ++i) {
+                alloc_traits::construct(alloc_, to + i, std::move(from[i]));
+                alloc_traits::destroy(alloc_, from + i);
+            }
+        } else {
+            // Copy all n before destroying any source, so a throw leaves them in old_
+            size_t built = 0;
+            try {
+                for (; built < n; ++built) alloc_traits::construct(alloc_, to + built, std::as_const(from[built]));
+            } catch (...) {
+                while (built > 0) alloc_traits::destroy(alloc_, to + --built);
+                throw;
+            }
+            for (size_t i = 0; i < n; ++i) alloc_traits::destroy(alloc_, from + i);
+        }
+    }
+
+    // Moves up to n pending elements (lowest positions first) into data_.
+    void migrate(size_t n) {
+        n = std::min(n, pending_hi_ - pending_lo_);
+        relocate(old_ + (pending_lo_ - shift_), n, data_ + pending_lo_);
+        pending_lo_ += n;
+        if (pending_lo_ == pending_hi_) end_migration();
+    }
+
+    void end_migration() noexcept {
+        if (old_) alloc_traits::deallocate(alloc_, old_, old_capacity_);
+        old_ = nullptr;
+        old_capacity_ = 0;
+        pending_lo_ = pending_hi_ = shift_ = 0;
+    }
+
+    // Called when head_ or tail_ reaches the block edge: start moving into a new block.
+    void begin_migration() {
+        // The step is sized so that a migration ends before the next edge; one is
+        // only still pending here if a relocation threw
+        finish_migration();
+
+        const size_t current_size = size();
+        const size_t new_capacity = (current_size > 2 && current_size < Policy::growth::recenter_limit(capacity_, sizeof(T)))
+            ? capacity_
+            : Policy::growth::next_capacity(capacity_, current_size + 2, ResizeMult, sizeof(T));
+        T* new_data = alloc_traits::allocate(alloc_, new_capacity);
+        const size_t new_head = (new_capacity - current_size) / 2;
+
+        old_ = data_;
+        old_capacity_ = capacity_;
+        shift_ = new_head - head_;  // wraps around when moving left; positions use the same modular arithmetic
+        pending_lo_ = new_head;
+        pending_hi_ = new_head + current_size;
+
+        data_ = new_data;
+        capacity_ = new_capacity;
+        head_ = new_head;
+        tail_ = new_head + current_size;
+
+        // Enough per operation to drain the old block before either side of the
+        // new one can fill up, plus one to cover the operation itself.
+        const size_t slack = std::max<size_t>(std::min(head_, capacity_ - tail_), 1);
+        step_ = (current_size + slack - 1) / slack + 1;
+
+        if (current_size == 0) end_migration();
+    }
+
+    void advance() {
+        if (old_) migrate(step_);
+    }
+
+    void destroy_all() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t pos = head_; pos < tail_; ++pos) alloc_traits::destroy(alloc_, slot(pos));
+        }
+    }
+
+public:
+    IncrementalShiftToMiddleArray() : IncrementalShiftToMiddleArray(8) {}
+
+    explicit IncrementalShiftToMiddleArray(size_t initial_capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc), capacity_(std::max<size_t>(initial_capacity, 1))
+    {
+        data_ = alloc_traits::allocate(alloc_, capacity_);
+        head_ = tail_ = capacity_ / 2;
+    }
+
+    ~IncrementalShiftToMiddleArray() {
+        destroy_all();
+        end_migration();
+        if (data_) alloc_traits::deallocate(alloc_, data_, capacity_);
+    }
+
+    IncrementalShiftToMiddleArray(const IncrementalShiftToMiddleArray& other)
+        : IncrementalShiftToMiddleArray(std::max<size_t>(other.capacity_, 1),
+                                        alloc_traits::select_on_container_copy_construction(other.alloc_))
+    {
+        head_ = tail_ = other.head_;
+        for (size_t i = 0; i < other.size(); ++i) {
+            alloc_traits::construct(alloc_, data_ + tail_, other[i]);
+            ++tail_;
+        }
+    }
+
+    IncrementalShiftToMiddleArray(IncrementalShiftToMiddleArray&& other) noexcept
+        : alloc_(std::move(other.alloc_)), data_(other.data_),
+          head_(other.head_), tail_(other.tail_), capacity_(other.capacity_),
+          old_(other.old_), old_capacity_(other.old_capacity_),
+          pending_lo_(other.pending_lo_), pending_hi_(other.pending_hi_),
+          shift_(other.shift_), step_(other.step_)
+    {
+        other.data_ = other.old_ = nullptr;
+        other.head_ = other.tail_ = other.capacity_ = other.old_capacity_ = 0;
+        other.pending_lo_ = other.pending_hi_ = other.shift_ = 0;
+    }
+
+    IncrementalShiftToMiddleArray& operator=(IncrementalShiftToMiddleArray other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(IncrementalShiftToMiddleArray& other) noexcept {
+        using std::swap;
+        if constexpr (alloc_traits::propagate_on_container_swap::value) swap(alloc_, other.alloc_);
+        swap(data_, other.data_);
+        swap(head_, other.head_);
+        swap(tail_, other.tail_);
+        swap(capacity_, other.capacity_);
+        swap(old_, other.old_);
+        swap(old_capacity_, other.old_capacity_);
+        swap(pending_lo_, other.pending_lo_);
+        swap(pending_hi_, other.pending_hi_);
+        swap(shift_, other.shift_);
+        swap(step_, other.step_);
+    }
+
+    friend void swap(IncrementalShiftToMiddleArray& a, IncrementalShiftToMiddleArray& b) noexcept { a.swap(b); }
+
+    // Capacity observers
+
+    size_t size() const noexcept { return tail_ - head_; }
+    bool empty() const noexcept { return head_ == tail_; }
+    size_t capacity() const noexcept { return capacity_; }
+    bool is_migrating() const noexcept { return old_ != nullptr; }
+
+    // Completes a pending migration at once (O(size) in the worst case)
+    void finish_migration() {
+        if (old_) migrate(pending_hi_ - pending_lo_);
+    }
+
+    // Accessors
+
+    T& operator[](size_t index) {
+        check(index < size(), "Index out of range");
+        return *slot(head_ + index);
+    }
+
+    const T& operator[](size_t index) const {
+        check(index < size(), "Index out of range");
+        return *slot(head_ + index);
+    }
+
+    T& front() { check(!empty(), "Array is empty"); return *slot(head_); }
+    const T& front() const { check(!empty(), "Array is empty"); return *slot(head_); }
+    T& back() { check(!empty(), "Array is empty"); return *slot(tail_ - 1); }
+    const T& back() const { check(!empty(), "Array is empty"); return *slot(tail_ - 1); }
+
+    // Contiguous view of the elements; finishes any pending migration
+    T* data() {
+        finish_migration();
+        return data_ + head_;
+    }
+
+    // Modifiers
+
+    // At an edge, a value that is one of the elements still in the old block is
+    // copied (or moved) out first, since starting the next migration frees it
+
+    void push_front(const T& value) {
+        if (head_ == 0) [[unlikely]] {
+            if (in_old_block(std::addressof(value))) {
+                push_front(T(value));
+                return;
+            }
+            begin_migration();
+        }
+        alloc_traits::construct(alloc_, data_ + head_ - 1, value);
+        --head_;
+        advance();
+    }
+
+    void push_front(T&& value) {
+        if (head_ == 0) [[unlikely]] {
+            if (in_old_block(std::addressof(value))) {
+                T taken(std::move(value));
+                push_front(std::move(taken));
+                return;
+            }
+            begin_migration();
+        }
+        alloc_traits::construct(alloc_, data_ + head_ - 1, std::move(value));
+        --head_;
+        advance();
+    }
+
+    void push_back(const T& value) {
+        if (tail_ == capacity_) [[unlikely]] {
+            if (in_old_block(std::addressof(value))) {
+                push_back(T(value));
+                return;
+            }
+            begin_migration();
+        }
+        alloc_traits::construct(alloc_, data_ + tail_, value);
+        ++tail_;
+        advance();
+    }
+
+    void push_back(T&& value) {
+        if (tail_ == capacity_) [[unlikely]] {
+            if (in_old_block(std::addressof(value))) {
+                T taken(std::move(value));
+                push_back(std::move(taken));
+                return;
+            }
+            begin_migration();
+        }
+        alloc_traits::construct(alloc_, data_ + tail_, std::move(value));
+        ++tail_;
+        advance();
+    }
+
+    void push(const T& value) { push_back(value); }
+    void push(T&& value) { push_back(std::move(value)); }
+
+    void pop_front() {
+        if (empty()) return;
+        alloc_traits::destroy(alloc_, slot(head_));
+        if (head_ == pending_lo_ && old_) ++pending_lo_;
+        ++head_;
+        if (old_ && pending_lo_ == pending_hi_) end_migration();
+        advance();
+    }
+
+    void pop_back() {
+        if (empty()) return;
+        alloc_traits::destroy(alloc_, slot(tail_ - 1));
+        if (tail_ == pending_hi_ && old_) --pending_hi_;
+        --tail_;
+        if (old_ && pending_lo_ == pending_hi_) end_migration();
+        advance();
+    }
+
+    void pop() { pop_front(); }
+
+    void clear() noexcept {
+        destroy_all();
+        end_migration();
+        head_ = tail_ = capacity_ / 2;
+    }
+};
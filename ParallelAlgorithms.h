@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>    // std::sort, std::inplace_merge, std::min
+#include <concepts>     // std::convertible_to
+#include <cstddef>      // std::size_t
+#include <exception>    // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <functional>   // std::plus, std::less
+#include <numeric>      // std::inclusive_scan
+#include <stdexcept>    // std::length_error
+#include <utility>      // std::move
+#include <vector>       // std::vector
+#ifdef _OPENMP
+#include <omp.h>        // omp_get_max_threads
+#endif
+
+// Parallel for_each, transform, reduce, inclusive_scan and sort over a single
+// contiguous block: a pointer range, or any container with data() and size()
+// such as ShiftToMiddleArray (whose data() restores a contiguous layout in ring
+// mode) or std::vector.
+//
+// The range is cut into at most one chunk per thread, each at least `grain`
+// elements long, and the chunks run on OpenMP threads. Built without OpenMP
+// (no -fopenmp) the same code runs the chunks one after another. Ranges shorter
+// than two grains stay on the calling thread. An exception thrown by the
+// element function is rethrown on the calling thread once all chunks are done
+// (the first chunk's one, if several threw); elements already processed keep
+// their new values.
+
+#ifdef _OPENMP
+#define STM_OMP(directive) _Pragma(#directive)
+#else
+#define STM_OMP(directive)
+#endif
+
+namespace stm::parallel {
+
+struct Options {
+	// Smallest number of elements worth handing to a thread
+	size_t grain = 1 << 15;
+
+	// Thread count; 0 uses the OpenMP default (OMP_NUM_THREADS or the core count)
+	int threads = 0;
+};
+
+namespace detail {
+
+inline int thread_count(const Options& options) {
+#ifdef _OPENMP
+	return options.threads > 0 ? options.threads : omp_get_max_threads();
+#else
+	(void)options;
+	return 1;
+#endif
+}
+
+// Calls fn(begin, end, chunk) for `chunks` equal slices of [0, n), in parallel
+template <typename Fn>
+void run_chunks(size_t n, size_t chunks, int threads, Fn&& fn) {
+	if (chunks == 1) {
+		fn(0, n, 0);
+		return;
+	}
+	std::vector<std::exception_ptr> errors(chunks);
+	const long long count = static_cast<long long>(chunks);
+	STM_OMP(omp parallel for num_threads(threads) schedule(static, 1))
+	for (long long i = 0; i < count; ++i) {
+		const size_t c = static_cast<size_t>(i);
+		try {
+			fn(n * c / chunks, n * (c + 1) / chunks, c);
+		} catch (...) {
+			errors[c] = std::current_exception();
+		}
+	}
+	(void)threads;
+	for (const std::exception_ptr& e : errors) {
+		if (e) std::rethrow_exception(e);
+	}
+}
+
+// Number of chunks for n elements: one per thread, none shorter than the grain
+inline size_t chunk_count(size_t n, const Options& options) {
+	const size_t grain = std::max<size_t>(options.grain, 1);
+	return std::max<size_t>(1, std::min(static_cast<size_t>(thread_count(options)), n / grain));
+}
+
+} // namespace detail
+
+// f(element) for every element, in no particular order
+template <typename T, typename F>
+void for_each(T* first, T* last, F f, const Options& options = {}) {
+	const size_t n = static_cast<size_t>(last - first);
+	detail::run_chunks(n, detail::chunk_count(n, options), detail::thread_count(options),
+		[&](size_t b, size_t e, size_t) { std::for_each(first + b, first + e, f); });
+}
+
+// out[i] = f(first[i]); out may be first
+template <typename T, typename U, typename F>
+void transform(const T* first, const T* last, U* out, F f, const Options& options = {}) {
+	const size_t n = static_cast<size_t>(last - first);
+	detail::run_chunks(n, detail::chunk_count(n, options), detail::thread_count(options),
+		[&](size_t b, size_t e, size_t) { std::transform(first + b, first + e, out + b, f); });
+}
+
+// init combined with every element. As for std::reduce, op must be associative
+// and accept any mix of R and T; unlike std::reduce the elements are combined
+// in order, so it need not be commutative.
+template <typename T, typename R = T, typename BinaryOp = std::plus<>>
+R reduce(const T* first, const T* last, R init = R{}, BinaryOp op = BinaryOp(), const Options& options = {}) {
+	const size_t n = static_cast<size_t>(last - first);
+	const size_t chunks = detail::chunk_count(n, options);
+	if (chunks == 1) {
+		for (; first != last; ++first) init = op(std::move(init), *first);
+		return init;
+	}
+	std::vector<R> partial;
+	partial.reserve(chunks);
+	for (size_t c = 0; c < chunks; ++c) partial.push_back(R(first[n * c / chunks]));
+	detail::run_chunks(n, chunks, detail::thread_count(options), [&](size_t b, size_t e, size_t c) {
+		R acc = std::move(partial[c]);
+		for (size_t i = b + 1; i < e; ++i) acc = op(std::move(acc), first[i]);
+		partial[c] = std::move(acc);
+	});
+	for (R& p : partial) init = op(std::move(init), std::move(p));
+	return init;
+}
+
+// out[i] = first[0] op ... op first[i]; out may be first. op must be associative.
+// Two passes: each chunk scans on its own, then adds the total of the chunks
+// before it.
+template <typename T, typename BinaryOp = std::plus<>>
+void inclusive_scan(const T* first, const T* last, T* out, BinaryOp op = BinaryOp(), const Options& options = {}) {
+	const size_t n = static_cast<size_t>(last - first);
+	const size_t chunks = detail::chunk_count(n, options);
+	const int threads = detail::thread_count(options);
+	detail::run_chunks(n, chunks, threads,
+		[&](size_t b, size_t e, size_t) { std::inclusive_scan(first + b, first + e, out + b, op); });
+	if (chunks == 1) return;
+
+	std::vector<T> carry;  // carry[c - 1]: everything in front of chunk c
+	carry.reserve(chunks - 1);
+	carry.push_back(out[n / chunks - 1]);
+	for (size_t c = 2; c < chunks; ++c) carry.push_back(op(carry.back(), out[n * c / chunks - 1]));
+	detail::run_chunks(n, chunks, threads, [&](size_t b, size_t e, size_t c) {
+		if (c == 0) return;
+		for (size_t i = b; i < e; ++i) out[i] = op(carry[c - 1], out[i]);
+	});
+}
+
+// Sorts each chunk in parallel, then merges neighbouring runs pairwise, the
+// merges of one round again in parallel. Not stable, like std::sort.
+template <typename T, typename Compare = std::less<>>
+void sort(T* first, T* last, Compare comp = Compare(), const Options& options = {}) {
+	const size_t n = static_cast<size_t>(last - first);
+	const size_t chunks = detail::chunk_count(n, options);
+	const int threads = detail::thread_count(options);
+	detail::run_chunks(n, chunks, threads,
+		[&](size_t b, size_t e, size_t) { std::sort(first + b, first + e, comp); });
+
+	// Round with run width w: runs [2kw, (2k+1)w) and [(2k+1)w, (2k+2)w), in chunks
+	for (size_t w = 1; w < chunks; w *= 2) {
+		const size_t merges = (chunks + 2 * w - 1) / (2 * w);
+		detail::run_chunks(merges, merges, threads, [&](size_t k, size_t, size_t) {
+			const size_t lo = 2 * k * w;
+			const size_t mid = std::min(lo + w, chunks);
+			const size_t hi = std::min(lo + 2 * w, chunks);
+			if (mid == hi) return;
+			std::inplace_merge(first + n * lo / chunks, first + n * mid / chunks, first + n * hi / chunks, comp);
+		});
+	}
+}
+
+// Container forms, over data() .. data() + size(). The calls are qualified so
+// that argument-dependent lookup cannot pick e.g. std::inclusive_scan.
+
+template <typename C>
+concept contiguous_container = requires(C& c) {
+	{ c.data() } -> std::convertible_to<const void*>;
+	{ c.size() } -> std::convertible_to<size_t>;
+};
+
+template <contiguous_container Container, typename F>
+void for_each(Container& c, F f, const Options& options = {}) {
+	parallel::for_each(c.data(), c.data() + c.size(), std::move(f), options);
+}
+
+// In place: every element replaced by f(element)
+template <contiguous_container Container, typename F>
+void transform(Container& c, F f, const Options& options = {}) {
+	parallel::transform(c.data(), c.data() + c.size(), c.data(), std::move(f), options);
+}
+
+// out must already hold at least in.size() elements
+template <contiguous_container In, contiguous_container Out, typename F>
+void transform(const In& in, Out& out, F f, const Options& options = {}) {
+	if (out.size() < in.size()) throw std::length_error("transform: output shorter than input");
+	parallel::transform(in.data(), in.data() + in.size(), out.data(), std::move(f), options);
+}
+
+template <contiguous_container Container, typename R, typename BinaryOp = std::plus<>>
+R reduce(const Container& c, R init, BinaryOp op = BinaryOp(), const Options& options = {}) {
+	return parallel::reduce(c.data(), c.data() + c.size(), std::move(init), std::move(op), options);
+}
+
+// In place
+template <contiguous_container Container, typename BinaryOp = std::plus<>>
+void inclusive_scan(Container& c, BinaryOp op = BinaryOp(), const Options& options = {}) {
+	parallel::inclusive_scan(c.data(), c.data() + c.size(), c.data(), std::move(op), options);
+}
+
+template <contiguous_container Container, typename Compare = std::less<>>
+void sort(Container& c, Compare comp = Compare(), const Options& options = {}) {
+	parallel::sort(c.data(), c.data() + c.size(), std::move(comp), options);
+}
+
+} // namespace stm::parallel
+
+#undef STM_OMP
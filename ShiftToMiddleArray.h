@@ -1,263 +1,1289 @@
 #pragma once
 
-#include <cstdlib>      // std::malloc, std::free, std::size_t
+#include <cstdlib>      // std::size_t
 #include <cstring>      // std::memcpy, std::memmove
-#include <memory>       // std::uninitialized_copy, std::uninitialized_move, std::addressof
+#include <memory>       // std::allocator, std::allocator_traits, std::addressof
+#include <memory_resource> // std::pmr::polymorphic_allocator
 #include <stdexcept>    // std::out_of_range, std::bad_alloc, std::logic_error
 #include <cassert>      // assert()
 #include <type_traits>  // std::is_trivially_copyable_v, etc.
 #include <algorithm>    // std::max, std::min, std::clamp, std::move, std::move_backward, std::swap
+#include <functional>   // std::equal_to
 #include <utility>      // std::swap (used via <algorithm>), std::forward
 #include <iterator>     // std::random_access_iterator_tag, std::ptrdiff_t, std::reverse_iterator
-#include <ostream>      // std::ostream, std::istream
+#include <ranges>       // std::ranges::input_range, std::ranges::begin, std::ranges::distance
+#include <initializer_list> // std::initializer_list
+#include <ostream>      // std::ostream
+#include <istream>      // std::istream
+#include <span>         // std::span
+#include <cstdint>      // std::uintptr_t
+#ifdef __linux__
+#include <sys/mman.h>   // madvise
+#include <unistd.h>     // sysconf
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>  // _mm_stream_si128, _mm_sfence
+#endif
+#include "SimdKernels.h" // stm::simd::find, count, sum, extreme, lower_bound
+
+namespace stm {
+
+// Opt-in trait for types that can be moved to a new address with a plain
+// memcpy/memmove while the source is simply forgotten (no destructor call).
+// Trivially copyable types qualify automatically; owning handles such as
+// std::unique_ptr can opt in with a specialization:
+//
+//   template <typename U, typename D>
+//   struct stm::is_trivially_relocatable<std::unique_ptr<U, D>> : std::true_type {};
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Growth strategies, selected with Policy::growth. next_capacity() returns the
+// capacity of the next block when `required` elements of elem_size bytes must
+// fit; `factor` is the array's ResizeMult. recenter_limit() is the largest size
+// at which an edge hit recenters the block instead of growing it; it has to
+// match the growth rate, or a block that grew by less than 2x would keep growing
+// under FIFO traffic instead of shifting.
+
+// capacity * factor at every size (the classic behaviour).
+struct GeometricGrowth {
+	static constexpr size_t next_capacity(size_t capacity, size_t required, size_t factor, size_t) noexcept {
+		return std::max(capacity * factor, required);
+	}
+
+	static constexpr size_t recenter_limit(size_t capacity, size_t) noexcept { return capacity / 2; }
+};
+
+// capacity * factor while the block is smaller than ThresholdBytes, 1.5x above
+// it. The result is rounded up to what the allocator hands out anyway: a power
+// of two for blocks up to PageBytes (malloc size classes), whole pages above, so
+// the rounding slack becomes usable capacity instead of hidden waste.
+template <size_t ThresholdBytes = (size_t(1) << 20), size_t PageBytes = 4096>
+struct AdaptiveGrowth {
+	static_assert((PageBytes & (PageBytes - 1)) == 0, "PageBytes must be a power of two");
+
+	static constexpr size_t next_capacity(size_t capacity, size_t required, size_t factor, size_t elem_size) noexcept {
+		const size_t grown = capacity * elem_size < ThresholdBytes ? capacity * factor : capacity + capacity / 2;
+		const size_t bytes = std::max(grown, required) * elem_size;
+		size_t rounded;
+		if (bytes <= PageBytes) {
+			rounded = 16;
+			while (rounded < bytes) rounded *= 2;
+		} else {
+			rounded = (bytes + PageBytes - 1) & ~(PageBytes - 1);
+		}
+		return std::max(rounded / elem_size, required);
+	}
 
-#define BIAS_MULT 0.05f  // Toggle adaptive midpoint
-//#define ALLOW_SHRINKING  // Toggle dynamic downsizing
-#define STM_BOUNDS_CHECK  // Toggle this for bounds checking
+	static constexpr size_t recenter_limit(size_t capacity, size_t elem_size) noexcept {
+		return capacity * elem_size < ThresholdBytes ? capacity / 2 : capacity - capacity / 3;
+	}
+};
+
+// What happens to the slot of a removed element:
+// - Auto: destroy non-trivial types, leave trivially copyable ones as they are
+// - Lazy: never destroy (fastest, but leaks resources held by non-trivial types)
+// - Always: always destroy
+enum class CleanupMode { Auto, Lazy, Always };
+
+// How automatic shrinking (Policy::allow_shrinking) and shrink_to_fit() give
+// memory back:
+// - Reallocate: move the elements into a block about twice their size
+// - ReleasePages: keep the block and hand the whole pages outside the elements
+//   back to the kernel (madvise MADV_DONTNEED). No element moves and capacity()
+//   stays; a released page returns, zero-filled, when a push reaches it again.
+// - ReleasePagesLazily: the same with MADV_FREE, which the kernel only reclaims
+//   under memory pressure; cheaper when the queue refills soon.
+// Page release needs Linux; elsewhere both release modes reallocate.
+enum class ShrinkMode { Reallocate, ReleasePages, ReleasePagesLazily };
+
+// Compile-time tuning of ShiftToMiddleArray. Every knob is read with if constexpr,
+// so disabled features cost nothing. To change some of them, derive and shadow:
+//
+//   struct ShrinkingPolicy : stm::DefaultPolicy {
+//       static constexpr bool allow_shrinking = true;
+//   };
+//   ShiftToMiddleArray<int, 2, std::allocator<int>, ShrinkingPolicy> queue;
+//
+// The defaults still honour the BIAS_MULT, ALLOW_SHRINKING and CLEANUP_MODE_*
+// macros of earlier versions when they are defined before the include.
+struct DefaultPolicy {
+	// How the capacity grows (GeometricGrowth or AdaptiveGrowth<...>)
+	using growth = GeometricGrowth;
+
+	// Shift of the midpoint per push that hits an edge, as a fraction of the
+	// capacity. 0 places the elements in the exact middle on every resize.
+#ifdef BIAS_MULT
+	static constexpr float bias_step = BIAS_MULT;
+#else
+	static constexpr float bias_step = 0.05f;
+#endif
 
-#ifdef STM_BOUNDS_CHECK
-  #define STM_ASSERT(cond, msg) assert((cond) && (msg))
+	// Reallocate to 2 * size() (at least 4) when pops leave the array less than
+	// 1 / shrink_divisor full.
+#ifdef ALLOW_SHRINKING
+	static constexpr bool allow_shrinking = true;
 #else
-  #define STM_ASSERT(cond, msg) ((void)0)
+	static constexpr bool allow_shrinking = false;
 #endif
+	static constexpr size_t shrink_divisor = 8;
+	static constexpr ShrinkMode shrink_mode = ShrinkMode::Reallocate;
+
+	// Blocks of at least this many bytes ask for transparent huge pages
+	// (madvise MADV_HUGEPAGE, Linux only), which cuts TLB misses on big scans and
+	// page faults while a large block fills. 0 leaves the kernel default.
+	static constexpr size_t huge_page_threshold = 0;
+
+	// Workload-tracking placement. Pushes and pops are counted per end (one add
+	// each); at every resize or recentering the net demand on each end is folded
+	// into an exponentially weighted average, which then splits the free slots:
+	// a 90/10 push_back/push_front mix gets ~90% of the slack at the tail and pure
+	// FIFO traffic leaves only min_slack_share at the head. Replaces bias_step.
+	static constexpr bool adaptive_bias = false;
+	static constexpr float bias_weight = 0.5f;       // weight of the newest sample
+	static constexpr float min_slack_share = 1.0f / 16; // per side, in [0, 0.5]
+
+	// Drift-aware recentering. Once drift_threshold recenterings in a row were
+	// triggered by the same end (steady FIFO-like drift), the next one moves the
+	// window up against the opposite end, keeping only drift_slack of the free
+	// slots behind it, instead of centering it. A shift costs size() moves however
+	// far it goes, so the saving comes from shifting less often. 0 disables it;
+	// ignored with adaptive_bias, which already places by demand.
+	static constexpr unsigned drift_threshold = 2;
+	static constexpr float drift_slack = 1.0f / 16;
+
+	// Ring-wrap mode for queue traffic. When the back end runs out while the drift
+	// detection above reports steady push_back/pop_front use, push_back carries on
+	// at the start of the block instead of shifting, as in a ring buffer.
+	// push_back, pop_front, pop_back, operator[], front(), back() and size() work
+	// on the wrapped layout; every other member first restores a contiguous one
+	// (a single pass over the elements). Requires drift_threshold > 0 and no
+	// adaptive_bias.
+	static constexpr bool ring_wrap = false;
+
+	// Number of elements stored inside the object itself. A block of up to this
+	// many elements lives there instead of on the heap; growth past it goes to
+	// the allocator as usual, and shrinking back below it returns to the inline
+	// buffer. Used by SmallShiftToMiddleArray. Requires a T that can be moved
+	// without throwing, and an allocator without in-place growth.
+	static constexpr size_t inline_capacity = 0;
+
+	// Relocations of trivially relocatable elements of at least this many bytes
+	// (reallocation, recentering, shrink_to_fit) use non-temporal stores, which
+	// write around the caches instead of evicting the working set with data that
+	// is not read again soon. Worth it for blocks well beyond the last-level
+	// cache; 0 keeps std::memcpy / std::memmove for every size.
+	static constexpr size_t large_copy_threshold = 0;
+
+	// Keep the counters returned by ShiftToMiddleArray::stats()
+	static constexpr bool collect_stats = false;
+
+	// assert() on out-of-range indices and empty front()/back(). The asserts
+	// follow NDEBUG; a policy with false turns accesses into bare pointer reads.
+	static constexpr bool bounds_check = true;
+
+#if defined(CLEANUP_MODE_ALWAYS)
+	static constexpr CleanupMode cleanup = CleanupMode::Always;
+#elif defined(CLEANUP_MODE_LAZY)
+	static constexpr CleanupMode cleanup = CleanupMode::Lazy;
+#else
+	static constexpr CleanupMode cleanup = CleanupMode::Auto;
+#endif
+};
+
+// Policy with room for N elements inside the object (see inline_capacity)
+template <size_t N, typename Base = DefaultPolicy>
+struct InlinePolicy : Base {
+	static constexpr size_t inline_capacity = N;
+};
+
+// Policy streaming relocations from Threshold bytes on (see large_copy_threshold)
+template <size_t Threshold = (size_t(64) << 20), typename Base = DefaultPolicy>
+struct LargeCopyPolicy : Base {
+	static constexpr size_t large_copy_threshold = Threshold;
+};
+
+// Policy that shrinks by releasing pages instead of reallocating (see ShrinkMode)
+template <ShrinkMode Mode = ShrinkMode::ReleasePages, typename Base = DefaultPolicy>
+struct PageReleasePolicy : Base {
+	static constexpr bool allow_shrinking = true;
+	static constexpr ShrinkMode shrink_mode = Mode;
+};
+
+// Relocation counters, see Policy::collect_stats
+struct Stats {
+	size_t bytes_moved = 0;    // element bytes relocated by shifts, reallocations and middle inserts/erases
+	size_t shifts = 0;         // recenterings within the same block
+	size_t reallocations = 0;  // moves into a new block
+};
 
-// Define one of these before including this header:
-// - CLEANUP_MODE_AUTO (default): Safe cleanup for non-trivial types, lazy for trivial types
-// - CLEANUP_MODE_LAZY: Never cleanup (fastest, but may leak for non-trivial types)
-// - CLEANUP_MODE_ALWAYS: Always cleanup (safest, but slower for trivial types)
+namespace detail {
 
-#if !defined(CLEANUP_MODE_AUTO) && !defined(CLEANUP_MODE_LAZY) && !defined(CLEANUP_MODE_ALWAYS)
-#define CLEANUP_MODE_AUTO
+template <bool Enabled>
+struct StatsCounter {
+	void moved(size_t) noexcept {}
+	void shifted() noexcept {}
+	void reallocated() noexcept {}
+};
+
+template <>
+struct StatsCounter<true> : Stats {
+	void moved(size_t bytes) noexcept { bytes_moved += bytes; }
+	void shifted() noexcept { ++shifts; }
+	void reallocated() noexcept { ++reallocations; }
+};
+
+// Net slack consumed at each end since the last fold, plus the running average
+// of the front's share. Empty unless Policy::adaptive_bias is set.
+template <bool Enabled>
+struct DemandTracker {
+	void on_front(std::ptrdiff_t) noexcept {}
+	void on_back(std::ptrdiff_t) noexcept {}
+};
+
+template <>
+struct DemandTracker<true> {
+	std::ptrdiff_t front = 0, back = 0;
+	float front_share = 0.5f;
+
+	void on_front(std::ptrdiff_t n) noexcept { front += n; }
+	void on_back(std::ptrdiff_t n) noexcept { back += n; }
+
+	// Folds the counters into the average and returns the share of the slack
+	// that should go in front of the elements.
+	float fold(float weight, float min_share) noexcept {
+		const float f = static_cast<float>(std::max<std::ptrdiff_t>(front, 0));
+		const float b = static_cast<float>(std::max<std::ptrdiff_t>(back, 0));
+		if (f + b > 0.0f) front_share += weight * (f / (f + b) - front_share);
+		front = back = 0;
+		return std::clamp(front_share, min_share, 1.0f - min_share);
+	}
+};
+
+// Raw, suitably aligned room for N elements (Policy::inline_capacity)
+template <typename T, size_t N>
+struct InlineStorage {
+	alignas(T) unsigned char bytes[N * sizeof(T)];
+	T* get() noexcept { return reinterpret_cast<T*>(bytes); }
+};
+
+template <typename T>
+struct InlineStorage<T, 0> {
+	T* get() noexcept { return nullptr; }
+};
+
+// Copies bytes from src to dest with non-temporal stores where the target has
+// them (SSE2), plain memcpy/memmove elsewhere. Forward when dest < src and
+// backward otherwise, 64 bytes at a time, each block loaded before it is
+// stored, so an overlap is fine.
+inline void stream_move(void* dest, const void* src, size_t bytes) noexcept {
+#if defined(__SSE2__) || defined(_M_X64)
+	auto* d = static_cast<unsigned char*>(dest);
+	const auto* s = static_cast<const unsigned char*>(src);
+	if (d == s || bytes < 256) {
+		std::memmove(d, s, bytes);
+		return;
+	}
+	if (d < s) {
+		// Unaligned head up to a 16-byte boundary of dest, then whole blocks
+		const size_t head = (16 - reinterpret_cast<std::uintptr_t>(d) % 16) % 16;
+		std::memmove(d, s, head);
+		size_t i = head;
+		for (; i + 64 <= bytes; i += 64) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 16));
+			const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 32));
+			const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 48));
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + i), a);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + i + 16), b);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + i + 32), c);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + i + 48), e);
+		}
+		_mm_sfence();
+		std::memmove(d + i, s + i, bytes - i);
+	} else {
+		// Mirror image: unaligned tail first, then whole blocks downwards
+		const size_t tail = reinterpret_cast<std::uintptr_t>(d + bytes) % 16;
+		std::memmove(d + bytes - tail, s + bytes - tail, tail);
+		size_t i = bytes - tail;
+		for (; i >= 64; i -= 64) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i - 64));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i - 48));
+			const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i - 32));
+			const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i - 16));
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + i - 64), a);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + i - 48), b);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + i - 32), c);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d + i - 16), e);
+		}
+		_mm_sfence();
+		std::memmove(d, s, i);
+	}
+#else
+	std::memmove(dest, src, bytes);
 #endif
+}
 
-// Internal helper macros for cleanup logic
-#ifdef CLEANUP_MODE_ALWAYS
-    #define SHOULD_CLEANUP_ELEMENT(T) true
-#elif defined(CLEANUP_MODE_LAZY)
-    #define SHOULD_CLEANUP_ELEMENT(T) false
-#else // CLEANUP_MODE_AUTO
-    #define SHOULD_CLEANUP_ELEMENT(T) (!std::is_trivially_copyable_v<T>)
+#ifdef __linux__
+inline constexpr bool can_release_pages = true;
+
+inline size_t page_size() noexcept {
+	static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	return size;
+}
+
+// madvise() over the whole pages inside [first, last); partial pages at either
+// end may still hold elements and are left alone.
+inline void advise_pages(const void* first, const void* last, int advice) noexcept {
+	const std::uintptr_t mask = page_size() - 1;
+	const std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(first) + mask) & ~mask;
+	const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(last) & ~mask;
+	if (begin >= end) return;
+	const bool ok = madvise(reinterpret_cast<void*>(begin), end - begin, advice) == 0;
+#ifdef MADV_FREE
+	// MADV_FREE needs Linux 4.5; a failed MADV_HUGEPAGE (THP disabled) is harmless
+	if (!ok && advice == MADV_FREE) madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+#else
+	(void)ok;
 #endif
+}
 
-// Cleanup implementation macro
-#define CLEANUP_ELEMENT_IF_NEEDED(ptr, T) \
-    do { \
-        if constexpr (SHOULD_CLEANUP_ELEMENT(T)) { \
-            (ptr)->~T(); \
-        } \
-    } while(0)
+inline void release_pages(const void* first, const void* last, bool lazily) noexcept {
+#ifdef MADV_FREE
+	advise_pages(first, last, lazily ? MADV_FREE : MADV_DONTNEED);
+#else
+	(void)lazily;
+	advise_pages(first, last, MADV_DONTNEED);
+#endif
+}
+
+inline void use_huge_pages(const void* first, const void* last) noexcept {
+	advise_pages(first, last, MADV_HUGEPAGE);
+}
+#else
+inline constexpr bool can_release_pages = false;
+inline void release_pages(const void*, const void*, bool) noexcept {}
+inline void use_huge_pages(const void*, const void*) noexcept {}
+#endif
+
+// Size at the last page release, raised to the high-water mark as elements
+// come back. Releasing again only once the size has halved since keeps a queue
+// drained pop by pop at O(log n) madvise calls. Empty unless pages are released.
+template <bool Enabled>
+struct ReleaseMark {
+	bool due(size_t) noexcept { return false; }
+	void released(size_t) noexcept {}
+};
+
+template <>
+struct ReleaseMark<true> {
+	size_t size = SIZE_MAX;
+
+	bool due(size_t current) noexcept {
+		if (current * 2 < size) return true;
+		size = std::max(size, current);
+		return false;
+	}
+	void released(size_t current) noexcept { size = current; }
+};
+
+template <bool Enabled>
+inline void check([[maybe_unused]] bool ok, [[maybe_unused]] const char* msg) {
+	if constexpr (Enabled) assert(ok && msg);
+}
+
+} // namespace detail
 
-template <typename T, size_t ResizeMult = 2>
+} // namespace stm
+
+template <typename T, size_t ResizeMult = 2, typename Allocator = std::allocator<T>, typename Policy = stm::DefaultPolicy>
 class ShiftToMiddleArray {
 
+public:
+    using allocator_type = Allocator;
+    using policy_type = Policy;
+
 private:
-    T* data;
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+                  "Allocator::value_type must match T");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, T*>,
+                  "Fancy allocator pointers are not supported");
+
+    // Allocators that can grow and release a block in place (VirtualMemoryAllocator.h)
+    static constexpr bool in_place_storage = requires(Allocator& a, T* p, size_t n) {
+        { a.extend(p, n, n, n) } -> std::same_as<T*>;
+        { a.trim(p, n, n, n) } -> std::same_as<T*>;
+    };
+
+    [[no_unique_address]] Allocator alloc_;
+    T* data_ = nullptr;
     size_t head, tail, capacity_;
-	float resize_multiplier;
-#ifdef BIAS_MULT
-	float bias;
-#endif
+	float bias = 0.0f;
+	int drift = 0;  // > 0: recent recenterings were forced by the back end, < 0: by the front
+	[[no_unique_address]] stm::detail::DemandTracker<Policy::adaptive_bias> demand;
+	[[no_unique_address]] stm::detail::StatsCounter<Policy::collect_stats> counters;
+	// Ring mode: the window is [head, capacity_) followed by [0, tail)
+	[[no_unique_address]] std::conditional_t<Policy::ring_wrap, bool, std::false_type> wrapped{};
+
+	static_assert(!Policy::ring_wrap || (Policy::drift_threshold > 0 && !Policy::adaptive_bias),
+	              "ring_wrap relies on drift detection (drift_threshold > 0, adaptive_bias off)");
+
+	[[no_unique_address]] stm::detail::InlineStorage<T, Policy::inline_capacity> inline_;
+
+	// Shrinking by madvise() rather than by reallocation (Policy::shrink_mode)
+	static constexpr bool release_pages = Policy::shrink_mode != stm::ShrinkMode::Reallocate && stm::detail::can_release_pages;
+	[[no_unique_address]] stm::detail::ReleaseMark<release_pages> released;
+
+	static_assert(Policy::inline_capacity == 0 ||
+	              (!in_place_storage && (stm::is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)),
+	              "inline_capacity needs a nothrow-movable T and an allocator without extend()/trim()");
+
+	static constexpr size_t default_capacity = Policy::inline_capacity > 0 ? Policy::inline_capacity : 8;
+
+	// Whether p is the inline buffer (blocks are only ever compared by their start)
+	bool is_inline(const T* p) noexcept {
+		if constexpr (Policy::inline_capacity > 0) return p == inline_.get();
+		else return false;
+	}
+
+	// Fixed-step bias, used unless the policy tracks the workload instead
+	static constexpr bool step_bias = !Policy::adaptive_bias && Policy::bias_step != 0.0f;
+
+	static constexpr bool cleanup_on_remove = Policy::cleanup == stm::CleanupMode::Always ||
+		(Policy::cleanup == stm::CleanupMode::Auto && !std::is_trivially_copyable_v<T>);
+
+	// Ends the lifetime of a removed element unless the cleanup mode skips it
+	void cleanup(T* p) {
+		if constexpr (cleanup_on_remove) alloc_traits::destroy(alloc_, p);
+	}
+
+	static void check(bool ok, const char* msg) { stm::detail::check<Policy::bounds_check>(ok, msg); }
+
+	size_t next_capacity(size_t capacity, size_t required) const noexcept {
+		return Policy::growth::next_capacity(capacity, required, ResizeMult, sizeof(T));
+	}
+
+	// Edge hits below this size recenter the block rather than growing it
+	size_t recenter_limit() const noexcept {
+		return Policy::growth::recenter_limit(capacity_, sizeof(T));
+	}
+
+	// Block index of the element at position index
+	size_t slot_of(size_t index) const noexcept {
+		size_t pos = head + index;
+		if constexpr (Policy::ring_wrap) {
+			if (pos >= capacity_) pos -= capacity_;
+		}
+		return pos;
+	}
+
+	// Whether p points into the block: at one of the elements (in either part of
+	// a wrapped window) or at a free slot. An argument for which this holds has
+	// to be copied or re-resolved before the elements are moved.
+	bool in_block(const T* p) const noexcept {
+		return std::less_equal<const T*>()(data_, p) && std::less<const T*>()(p, data_ + capacity_);
+	}
+
+	// Whether the next push_front / push_back moves the elements (unwrapping,
+	// recentering or growing the block)
+	bool front_full() const noexcept { return wrapped || head == 0; }
+	bool back_full() const noexcept { return wrapped ? tail == head : tail == capacity_; }
+
+	// The window as at most two runs: [head, tail), or [head, capacity_) followed
+	// by [0, tail) while wrapped (ring mode)
+	std::span<const T> first_run() const noexcept { return {data_ + head, wrapped ? capacity_ - head : tail - head}; }
+	std::span<const T> second_run() const noexcept { return {data_, wrapped ? tail : 0}; }
+
+	// Index of the first element equal to value, or size(). Searches the runs in
+	// place, so value may be one of the elements.
+	size_t find_index(const T& value) const {
+		const std::span<const T> a = first_run();
+		const std::span<const T> b = second_run();
+		const size_t i = static_cast<size_t>(stm::simd::find(a.data(), a.data() + a.size(), value) - a.data());
+		if (i < a.size() || b.empty()) return i;
+		return a.size() + static_cast<size_t>(stm::simd::find(b.data(), b.data() + b.size(), value) - b.data());
+	}
+
+	// Index of the first element not less than value (the elements are sorted)
+	size_t lower_bound_index(const T& value) const {
+		const std::span<const T> a = first_run();
+		const std::span<const T> b = second_run();
+		if (!b.empty() && a.back() < value) {
+			return a.size() + static_cast<size_t>(stm::simd::lower_bound(b.data(), b.data() + b.size(), value) - b.data());
+		}
+		return static_cast<size_t>(stm::simd::lower_bound(a.data(), a.data() + a.size(), value) - a.data());
+	}
+
+	// Smallest (Max false) or largest element of a non-empty window, the first
+	// one on ties
+	template <bool Max>
+	const T& extreme() const {
+		const std::span<const T> a = first_run();
+		const std::span<const T> b = second_run();
+		const T& x = *stm::simd::extreme<Max>(a.data(), a.data() + a.size());
+		if (b.empty()) return x;
+		const T& y = *stm::simd::extreme<Max>(b.data(), b.data() + b.size());
+		return (Max ? x < y : y < x) ? y : x;
+	}
+
+	void cleanup_range(T* first, T* last) {
+		if constexpr (cleanup_on_remove) {
+			for (; first != last; ++first) cleanup(first);
+		}
+	}
+
+	void cleanup_all() {
+		if constexpr (cleanup_on_remove) {
+			for (size_t i = 0, n = size(); i < n; ++i) cleanup(data_ + slot_of(i));
+		}
+	}
+
+	// Ring mode: wrap instead of recentering once the back end runs out under
+	// sustained FIFO drift. The slots in front of head become the new back.
+	bool try_wrap() noexcept {
+		if constexpr (Policy::ring_wrap) {
+			if (head > 0 && head < capacity_ && drift == static_cast<int>(Policy::drift_threshold) &&
+			    size() < recenter_limit()) {
+				tail = 0;
+				wrapped = true;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Restores a contiguous layout; a no-op outside ring mode
+	void unwrap() {
+		if constexpr (Policy::ring_wrap) {
+			if (wrapped) relinearize();
+		}
+	}
+
+	// Moves both halves of a wrapped window, in order, to the middle of a fresh
+	// block of the same capacity.
+	void relinearize() {
+		const size_t current_size = size();
+		const size_t first_part = capacity_ - head;
+		const size_t new_head = placement(capacity_);
+		T* new_data = allocate(capacity_);
+		if constexpr (stm::is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T> ||
+		              !std::is_copy_constructible_v<T>) {
+			relocate(data_ + head, data_ + capacity_, new_data + new_head);
+			relocate(data_, data_ + tail, new_data + new_head + first_part);
+		} else {
+			// Copy both halves before destroying anything, so a throw leaves *this intact
+			try {
+				copy_construct(data_ + head, data_ + capacity_, new_data + new_head);
+			} catch (...) {
+				deallocate(new_data, capacity_);
+				throw;
+			}
+			try {
+				copy_construct(data_, data_ + tail, new_data + new_head + first_part);
+			} catch (...) {
+				for (size_t i = 0; i < first_part; ++i) alloc_traits::destroy(alloc_, new_data + new_head + i);
+				deallocate(new_data, capacity_);
+				throw;
+			}
+			for (size_t i = 0; i < current_size; ++i) alloc_traits::destroy(alloc_, data_ + slot_of(i));
+		}
+		deallocate(data_, capacity_);
+		data_ = new_data;
+		head = new_head;
+		tail = new_head + current_size;
+		wrapped = {};
+		counters.reallocated();
+	}
+
+	// Guarantees a free slot at data_[tail] for push_back
+	void make_room_back() {
+		if constexpr (Policy::ring_wrap) {
+			if (wrapped) {
+				if (tail != head) [[likely]] return;
+				unwrap();  // the ring is full: back to one block, which then grows
+			}
+		}
+		if (tail == capacity_) [[unlikely]] {
+			if constexpr (step_bias) bias -= Policy::bias_step;
+			if (try_wrap()) return;
+			resize_if_needed();
+		}
+	}
+
+	// Storage goes through the allocator; a null block is never passed back to it.
+	// Blocks that fit the inline buffer use it while it is free.
+	T* allocate(size_t n) {
+		if constexpr (Policy::inline_capacity > 0) {
+			if (n <= Policy::inline_capacity && !is_inline(data_)) return inline_.get();
+		}
+		T* block = alloc_traits::allocate(alloc_, n);
+		if constexpr (Policy::huge_page_threshold > 0) {
+			if (n * sizeof(T) >= Policy::huge_page_threshold) stm::detail::use_huge_pages(block, block + n);
+		}
+		return block;
+	}
+
+	void deallocate(T* p, size_t n) {
+		if (p && !is_inline(p)) alloc_traits::deallocate(alloc_, p, n);
+	}
+
+	// Moves the elements, at the same slots, from block `from` laid out like
+	// *this to block `to`. Used to hand inline buffers between objects; cannot
+	// throw given the inline_capacity requirements.
+	void relocate_slots(T* from, T* to) noexcept {
+		if (wrapped) {
+			relocate(from + head, from + capacity_, to + head);
+			relocate(from, from + tail, to);
+		} else {
+			relocate(from + head, from + tail, to + head);
+		}
+	}
+
+	// Takes over other's block (copying it out of other's inline buffer if need
+	// be) and layout, leaving other empty without storage.
+	void steal_storage(ShiftToMiddleArray& other) noexcept {
+		if (other.is_inline(other.data_)) {
+			data_ = inline_.get();
+			other.relocate_slots(other.data_, data_);
+		} else {
+			data_ = other.data_;
+		}
+		head = other.head;
+		tail = other.tail;
+		capacity_ = other.capacity_;
+		wrapped = other.wrapped;
+		released = other.released;
+		other.data_ = nullptr;
+		other.head = other.tail = other.capacity_ = 0;
+		other.wrapped = {};
+		other.released = {};
+	}
+
+	// Copy-construct [first, last) into raw storage at dest. If a copy throws, the
+	// copies made so far are destroyed and the exception is propagated.
+	void copy_construct(const T* first, const T* last, T* dest) {
+		T* cur = dest;
+		try {
+			for (; first != last; ++first, ++cur) alloc_traits::construct(alloc_, cur, *first);
+		} catch (...) {
+			for (T* p = dest; p != cur; ++p) alloc_traits::destroy(alloc_, p);
+			throw;
+		}
+	}
+
+	// Relocation: move [first, last) into raw storage at dest and end the lifetime
+	// of the sources. Trivially relocatable types are memcpy'd, the rest are moved
+	// when that cannot throw and copied otherwise, so a throwing copy leaves the
+	// source range untouched.
+	void relocate(T* first, T* last, T* dest) {
+		counters.moved(static_cast<size_t>(last - first) * sizeof(T));
+		if constexpr (stm::is_trivially_relocatable_v<T>) {
+			if (first == last) return;
+			const size_t bytes = static_cast<size_t>(last - first) * sizeof(T);
+			if (Policy::large_copy_threshold > 0 && bytes >= Policy::large_copy_threshold) {
+				stm::detail::stream_move(dest, first, bytes);
+			} else {
+				std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), bytes);
+			}
+		} else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+			for (; first != last; ++first, ++dest) {
+				alloc_traits::construct(alloc_, dest, std::move(*first));
+				alloc_traits::destroy(alloc_, first);
+			}
+		} else {
+			copy_construct(first, last, dest);
+			for (; first != last; ++first) alloc_traits::destroy(alloc_, first);
+		}
+	}
+
+	// Same as relocate(), but the source and destination may overlap (in-place shifts).
+	void relocate_overlapping(T* first, T* last, T* dest) {
+		counters.moved(static_cast<size_t>(last - first) * sizeof(T));
+		if constexpr (stm::is_trivially_relocatable_v<T>) {
+			if (first == last) return;
+			const size_t bytes = static_cast<size_t>(last - first) * sizeof(T);
+			if (Policy::large_copy_threshold > 0 && bytes >= Policy::large_copy_threshold) {
+				stm::detail::stream_move(dest, first, bytes);
+			} else {
+				std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), bytes);
+			}
+		} else if (dest < first) {
+			for (; first != last; ++first, ++dest) {
+				alloc_traits::construct(alloc_, dest, std::move(*first));
+				alloc_traits::destroy(alloc_, first);
+			}
+		} else if (dest > first) {
+			T* dest_last = dest + (last - first);
+			while (last != first) {
+				alloc_traits::construct(alloc_, --dest_last, std::move(*--last));
+				alloc_traits::destroy(alloc_, last);
+			}
+		}
+	}
 
     void resize_if_needed() {
-		
-		size_t new_capacity;
-		
-#ifdef ALLOW_SHRINKING
-		if (size()  < capacity_ / 8 && capacity_ > 4) {  
-			new_capacity = std::max({
-				size()  * 2,
-				static_cast<size_t>(4),
-			});
+		// Page release keeps the block (see ShrinkMode): recenter or grow instead
+		if constexpr (Policy::allow_shrinking && !release_pages) {
+			if (size() < capacity_ / Policy::shrink_divisor && capacity_ > 4 && !is_inline(data_)) {
+				resize(std::max(size() * 2, static_cast<size_t>(4)));
+				return;
+			}
 		}
-		else
-#endif
-		
-		if (size()  > 2 && size() <  capacity_ / 2) {
+
+		if (size() > 2 && size() < recenter_limit()) {
+			if constexpr (in_place_storage) {
+				if (slide_window()) return;
+			}
 			shift_to_middle();
 			return;
 		}
-		
-		else {
-			new_capacity = static_cast<size_t>(capacity_ * ResizeMult);		
-		}
-		
-		resize(new_capacity);		
+
+		resize(next_capacity(capacity_, size() + 2));
     }
 	
 	void resize(size_t new_capacity) {
-        T* new_data = static_cast<T*>(std::malloc(new_capacity * sizeof(T)));
-        
-        if (!new_data) throw std::bad_alloc();
-
-        size_t new_head = (new_capacity - (tail - head)) / 2;
-
-#ifdef BIAS_MULT
-		// Apply dynamic biasing
-		bool bias_is_negative = (bias < 0.0f);
-		float abs_bias = std::abs(bias);
-		size_t bias_offset = static_cast<size_t>(abs_bias * static_cast<double>(new_capacity));
-
-		if (bias_is_negative) {
-			// Handle negative bias: shift left
-			if (bias_offset > new_head) {
-				new_head = 0;
-				bias += BIAS_MULT;
+        size_t new_head = placement(new_capacity);
+
+		if constexpr (step_bias) {
+			// Apply dynamic biasing
+			bool bias_is_negative = (bias < 0.0f);
+			float abs_bias = std::abs(bias);
+			size_t bias_offset = static_cast<size_t>(abs_bias * static_cast<double>(new_capacity));
+
+			if (bias_is_negative) {
+				// Handle negative bias: shift left
+				if (bias_offset > new_head) {
+					new_head = 0;
+					bias += Policy::bias_step;
+				} else {
+					new_head -= bias_offset;
+				}
 			} else {
-				new_head -= bias_offset;
+				// Handle non-negative bias: shift right
+				if (new_head + size()  + bias_offset > new_capacity) {
+					new_head = new_capacity - size() ;
+					bias -= Policy::bias_step;
+				} else {
+					new_head += bias_offset;
+				}
 			}
+		}
+
+		// Keep a free slot on both sides so the push that triggered the resize always fits
+		if (new_capacity >= size() + 2) {
+			new_head = std::clamp(new_head, static_cast<size_t>(1), new_capacity - size() - 1);
+		}
+
+		relayout(new_capacity, new_head);
+	}
+
+	// Head index that puts the window in the middle of a block of the given
+	// capacity, or splits the free slots by the tracked demand (adaptive bias).
+	// Called once per resize or recentering.
+	size_t placement(size_t capacity) {
+		const size_t spare = capacity - size();
+		if constexpr (Policy::adaptive_bias) {
+			const float share = demand.fold(Policy::bias_weight, Policy::min_slack_share);
+			const size_t new_head = static_cast<size_t>(share * static_cast<float>(spare));
+			// Whichever end triggered the call needs at least one free slot
+			return spare >= 2 ? std::clamp(new_head, static_cast<size_t>(1), spare - 1) : new_head;
 		} else {
-			// Handle non-negative bias: shift right
-			if (new_head + size()  + bias_offset > new_capacity) {
-				new_head = new_capacity - size() ;
-				bias -= BIAS_MULT;
-			} else {
-				new_head += bias_offset;
+			return spare / 2;
+		}
+	}
+
+	// Head index for a recentering within the current block. Tracks which end ran
+	// out; under steady drift the window goes next to the opposite end.
+	size_t recenter_target() {
+		if constexpr (!Policy::adaptive_bias && Policy::drift_threshold > 0) {
+			constexpr int limit = static_cast<int>(Policy::drift_threshold);
+			if (tail == capacity_) drift = drift > 0 ? std::min(drift + 1, limit) : 1;
+			else if (head == 0) drift = drift < 0 ? std::max(drift - 1, -limit) : -1;
+
+			if (drift == limit || drift == -limit) {
+				const size_t spare = capacity_ - size();
+				const size_t behind = std::clamp(static_cast<size_t>(Policy::drift_slack * static_cast<float>(spare)),
+				                                 static_cast<size_t>(1), spare - 1);
+				return drift > 0 ? behind : spare - behind;
 			}
 		}
-#endif
-		
-		//Copy data
-		if constexpr (std::is_trivially_copyable_v<T>) {
-			std::memcpy(new_data + new_head, data + head, (tail - head) * sizeof(T));
+		return placement(capacity_);
+	}
+
+	// Moves the live window to [new_head, new_head + size()) of a block of
+	// new_capacity elements. The current block is reused (in-place shift) when
+	// the capacity does not change, otherwise a new block is allocated.
+	void relayout(size_t new_capacity, size_t new_head) {
+		const size_t current_size = size();
+		if (new_capacity == capacity_) {
+			relocate_overlapping(data_ + head, data_ + tail, data_ + new_head);
+			counters.shifted();
 		} else {
-			std::uninitialized_copy(data + head, data + tail, new_data + new_head);
-			for (size_t i = head; i < tail; ++i) {
-				data[i].~T();
+			if constexpr (in_place_storage) {
+				if (new_capacity > capacity_ && data_ && extend_in_place(new_capacity, new_head)) return;
 			}
+			T* new_data = allocate(new_capacity);
+			try {
+				relocate(data_ + head, data_ + tail, new_data + new_head);
+			} catch (...) {
+				deallocate(new_data, new_capacity);
+				throw;
+			}
+			deallocate(data_, capacity_);
+			data_ = new_data;
+			capacity_ = new_capacity;
+			counters.reallocated();
 		}
+		head = new_head;
+		tail = new_head + current_size;
+	}
 
-        std::free(data);
-        data = new_data;
-        tail = new_head + (tail - head);
-        head = new_head;
-        capacity_ = new_capacity;		
+	// Growth for in-place storage: commit the extra capacity around the current
+	// block instead of copying, keeping the window close to new_head. Fails (and
+	// the caller reallocates) only when the reservation is exhausted.
+	bool extend_in_place(size_t new_capacity, size_t new_head) {
+		const size_t growth = new_capacity - capacity_;
+		const size_t front = new_head > head ? std::min(new_head - head, growth) : 0;
+		T* extended = alloc_.extend(data_, capacity_, front, growth - front);
+		if (!extended) return false;
+		data_ = extended;
+		capacity_ = new_capacity;
+		head += front;
+		tail += front;
+		return true;
+	}
+
+	// Recentering for in-place storage: rather than shifting the elements, slide
+	// the block itself. The starved side is extended and the same amount is
+	// released on the other side, so neither the elements nor the footprint move.
+	bool slide_window() {
+		const size_t target = placement(capacity_);
+		const size_t front = head < target ? target - head : 0;
+		const size_t back = head > target ? head - target : 0;
+		T* extended = alloc_.extend(data_, capacity_, front, back);
+		if (!extended) return false;
+		data_ = alloc_.trim(extended, capacity_ + front + back, back, front);
+		head = head + front - back;
+		tail = tail + front - back;
+		return true;
+	}
+
+	// Makes room for n more elements behind tail with a single relayout. The block
+	// is reused while the result stays within recenter_limit() (like shift_to_middle),
+	// otherwise it grows; three quarters of the slack go to the back.
+	void grow_back(size_t n) {
+		const size_t required = size() + n;
+		const size_t new_capacity = required <= recenter_limit() ? capacity_ : next_capacity(std::max(capacity_, required), required);
+		const size_t spare = new_capacity - required;
+		relayout(new_capacity, spare / 4);
+	}
+
+	// Mirror image of grow_back(): room for n more elements in front of head.
+	void grow_front(size_t n) {
+		const size_t required = size() + n;
+		const size_t new_capacity = required <= recenter_limit() ? capacity_ : next_capacity(std::max(capacity_, required), required);
+		const size_t spare = new_capacity - required;
+		relayout(new_capacity, spare - spare / 4 + n);
 	}
 	
-	#ifdef ALLOW_SHRINKING
+	// Opens a gap of k raw slots before position at (at <= size()) and returns its
+	// block index. Only the shorter side is shifted, or the longer one if only it
+	// has room; when neither side has k free slots the elements go straight to
+	// their final places in a new block, so each one moves at most once. head and
+	// tail already include the gap on return.
+	size_t open_gap(size_t at, size_t k) {
+		const bool front_cheaper = at < size() - at;
+		if constexpr (in_place_storage) {
+			// Growing in place keeps the elements where they are; then shift as usual
+			if (head < k && capacity_ - tail < k) {
+				if (front_cheaper) grow_front(k);
+				else grow_back(k);
+			}
+		}
+		const bool front_fits = head >= k;
+		const bool back_fits = capacity_ - tail >= k;
+		if (front_fits && (front_cheaper || !back_fits)) {
+			relocate_overlapping(data_ + head, data_ + head + at, data_ + head - k);
+			head -= k;
+			return head + at;
+		}
+		if (back_fits) {
+			relocate_overlapping(data_ + head + at, data_ + tail, data_ + head + at + k);
+			tail += k;
+			return head + at;
+		}
+
+		const size_t required = size() + k;
+		const size_t new_capacity = required <= recenter_limit() ? capacity_ : next_capacity(std::max(capacity_, required), required);
+		const size_t new_head = (new_capacity - required) / 2;
+		T* new_data = allocate(new_capacity);
+		if constexpr (stm::is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T> ||
+		              !std::is_copy_constructible_v<T>) {
+			relocate(data_ + head, data_ + head + at, new_data + new_head);
+			relocate(data_ + head + at, data_ + tail, new_data + new_head + at + k);
+		} else {
+			// Copy both sides before destroying anything, so a throw leaves *this intact
+			try {
+				copy_construct(data_ + head, data_ + head + at, new_data + new_head);
+			} catch (...) {
+				deallocate(new_data, new_capacity);
+				throw;
+			}
+			try {
+				copy_construct(data_ + head + at, data_ + tail, new_data + new_head + at + k);
+			} catch (...) {
+				for (size_t i = 0; i < at; ++i) alloc_traits::destroy(alloc_, new_data + new_head + i);
+				deallocate(new_data, new_capacity);
+				throw;
+			}
+			for (T* p = data_ + head; p != data_ + tail; ++p) alloc_traits::destroy(alloc_, p);
+		}
+		deallocate(data_, capacity_);
+		data_ = new_data;
+		capacity_ = new_capacity;
+		head = new_head;
+		tail = new_head + required;
+		counters.reallocated();
+		return head + at;
+	}
+
+	// Removes the k raw slots starting at block index pos from the window by
+	// shifting whichever side of them is shorter.
+	void close_gap(size_t pos, size_t k) {
+		if (pos - head < tail - (pos + k)) {
+			relocate_overlapping(data_ + head, data_ + pos, data_ + head + k);
+			head += k;
+		} else {
+			relocate_overlapping(data_ + pos + k, data_ + tail, data_ + pos);
+			tail -= k;
+		}
+	}
+
+	// Single-pass compaction behind erase_if() and unique(). first and back point
+	// at the first and last element to remove (first <= back); nothing outside
+	// them moves except the shorter of the two outer runs, so survivors are
+	// written towards whichever end needs fewer moves. removed(in, out) decides
+	// for the elements strictly between them: compacting towards the front, out
+	// is the next free slot and out[-1] the last kept element; towards the back,
+	// the elements before in are still untouched. Trivially copyable elements
+	// are copied unconditionally and the write position advanced by the test
+	// result, so the loop has no data-dependent branch. If removed() throws, the
+	// free slots are closed again and nothing not yet visited is lost.
+	template <typename Removed>
+	void compact(T* first, T* back, Removed removed) {
+		constexpr bool branchless = std::is_trivially_copyable_v<T>;
+		const auto drop = [this](T* p) {
+			if constexpr (!std::is_trivially_destructible_v<T>) alloc_traits::destroy(alloc_, p);
+		};
+		T* const begin = data_ + head;
+		T* const end = data_ + tail;
+
+		if (end - back - 1 <= first - begin) {
+			drop(first);
+			T* out = first;
+			T* in = first + 1;
+			try {
+				for (; in < back; ++in) {
+					if constexpr (branchless) {
+						const bool keep = !removed(static_cast<const T*>(in), static_cast<const T*>(out));
+						std::memcpy(static_cast<void*>(out), static_cast<const void*>(in), sizeof(T));
+						out += keep;
+					} else if (removed(static_cast<const T*>(in), static_cast<const T*>(out))) {
+						drop(in);
+					} else {
+						relocate(in, in + 1, out);
+						++out;
+					}
+				}
+			} catch (...) {
+				relocate_overlapping(in, end, out);
+				tail = static_cast<size_t>(out + (end - in) - data_);
+				throw;
+			}
+			if (back != first) drop(back);
+			if constexpr (branchless) counters.moved(static_cast<size_t>(out - first) * sizeof(T));
+			relocate_overlapping(back + 1, end, out);
+			tail = static_cast<size_t>(out + (end - back - 1) - data_);
+		} else {
+			drop(back);
+			T* out = back;
+			T* in = back - 1;
+			try {
+				for (; in > first; --in) {
+					if constexpr (branchless) {
+						const bool keep = !removed(static_cast<const T*>(in), static_cast<const T*>(out));
+						std::memcpy(static_cast<void*>(out), static_cast<const void*>(in), sizeof(T));
+						out -= keep;
+					} else if (removed(static_cast<const T*>(in), static_cast<const T*>(out))) {
+						drop(in);
+					} else {
+						relocate(in, in + 1, out);
+						--out;
+					}
+				}
+			} catch (...) {
+				relocate_overlapping(begin, in + 1, out - (in - begin));
+				head = static_cast<size_t>(out - (in - begin) - data_);
+				throw;
+			}
+			if (back != first) drop(first);
+			if constexpr (branchless) counters.moved(static_cast<size_t>(back - out) * sizeof(T));
+			relocate_overlapping(begin, first, out - (first - begin) + 1);
+			head = static_cast<size_t>(out - (first - begin) + 1 - data_);
+		}
+	}
+
 	void shrink_if_needed() {
-		if(size() < capacity_ / 8 && capacity_ > 4) {
-			resize(std::max({
-				size() * 2,
-				static_cast<size_t>(4),
-			}));
+		if constexpr (Policy::allow_shrinking) {
+			if (size() < capacity_ / Policy::shrink_divisor && capacity_ > 4 && !is_inline(data_)) {
+				if constexpr (release_pages) {
+					if (released.due(size())) release_unused_pages();
+					return;
+				}
+				unwrap();
+				resize(std::max(size() * 2, static_cast<size_t>(4)));
+			}
 		}
 	}
-	#endif
+
+	// Returns the pages in front of and behind the elements to the kernel
+	void release_unused_pages() {
+		unwrap();
+		const bool lazily = Policy::shrink_mode == stm::ShrinkMode::ReleasePagesLazily;
+		stm::detail::release_pages(data_, data_ + head, lazily);
+		stm::detail::release_pages(data_ + tail, data_ + capacity_, lazily);
+		released.released(size());
+	}
 		
 	void shift_to_middle() {
 		
 		const size_t current_size = size();
-		if (current_size == 0 || head == (capacity_ - current_size) / 2) return;
+		if (current_size == 0) return;
+		const size_t target = recenter_target();
+		if (head == target) return;
+
+		T* new_head = data_ + target;
+
+		relocate_overlapping(data_ + head, data_ + tail, new_head);
+		counters.shifted();
 
-		T* new_head = data + (capacity_ - current_size) / 2;
+		tail = (head = new_head - data_) + current_size;
+	}
 
-		if constexpr (std::is_trivially_copyable_v<T>) {
-			std::memmove(new_head, data + head, current_size * sizeof(T));
+	// Whether [first, last) is a non-empty range over this array's own slots
+	// (pointers, iterators or reverse iterators into it)
+	template <typename InputIt, typename Sentinel>
+	bool range_in_block(const InputIt& first, const Sentinel& last) const {
+		if constexpr (std::forward_iterator<InputIt> && std::is_lvalue_reference_v<std::iter_reference_t<InputIt>> &&
+		              std::same_as<std::iter_value_t<InputIt>, T>) {
+			return first != last && in_block(std::addressof(*first));
 		} else {
-			if (new_head < data + head) {  // Shift left
-				std::move(data + head, data + tail, new_head);
-				for (T* p = new_head + current_size; p < data + tail; ++p) p->~T();
-			} else {  // Shift right
-				std::move_backward(data + head, data + tail, new_head + current_size);
-				for (T* p = data + head; p < new_head; ++p) p->~T();
+			return false;
+		}
+	}
+
+	// Constructs n elements read from first into raw storage at dest. On exception
+	// the elements constructed so far are destroyed before rethrowing.
+	template <typename InputIt>
+	void construct_range(InputIt first, size_t n, T* dest) {
+		if constexpr (std::contiguous_iterator<InputIt> && std::is_trivially_copyable_v<T> &&
+		              std::is_same_v<std::iter_value_t<InputIt>, T>) {
+			if (n) std::memcpy(static_cast<void*>(dest), std::to_address(first), n * sizeof(T));
+		} else {
+			size_t i = 0;
+			try {
+				for (; i < n; ++i, ++first) alloc_traits::construct(alloc_, dest + i, *first);
+			} catch (...) {
+				while (i-- > 0) alloc_traits::destroy(alloc_, dest + i);
+				throw;
 			}
 		}
+	}
 
-		tail = (head = new_head - data) + current_size;
+	// Exchanges everything but the allocators
+	void swap_storage(ShiftToMiddleArray& other) noexcept {
+		using std::swap;
+		if constexpr (Policy::inline_capacity > 0) {
+			const bool mine = is_inline(data_);
+			const bool theirs = other.is_inline(other.data_);
+			if (mine || theirs) {
+				// Inline elements cannot change owner by pointer: move them across
+				stm::detail::InlineStorage<T, Policy::inline_capacity> spare;
+				if (mine) relocate_slots(data_, spare.get());
+				if (theirs) other.relocate_slots(other.data_, inline_.get());
+				if (mine) relocate_slots(spare.get(), other.inline_.get());
+				T* const my_block = data_;
+				data_ = theirs ? inline_.get() : other.data_;
+				other.data_ = mine ? other.inline_.get() : my_block;
+			} else {
+				swap(data_, other.data_);
+			}
+		} else {
+			swap(data_, other.data_);
+		}
+		swap(head, other.head);
+		swap(tail, other.tail);
+		swap(capacity_, other.capacity_);
+		swap(bias, other.bias);
+		swap(drift, other.drift);
+		swap(demand, other.demand);
+		swap(counters, other.counters);
+		swap(wrapped, other.wrapped);
+		swap(released, other.released);
 	}
 
 public:
-    ShiftToMiddleArray() : ShiftToMiddleArray(8) {}
+    ShiftToMiddleArray() : ShiftToMiddleArray(default_capacity) {}
 
-    explicit ShiftToMiddleArray(size_t initial_capacity) 
-        : capacity_(initial_capacity) 
+    explicit ShiftToMiddleArray(const Allocator& alloc) : ShiftToMiddleArray(default_capacity, alloc) {}
+
+    explicit ShiftToMiddleArray(size_t initial_capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc), capacity_(initial_capacity)
     {
 		if (initial_capacity == 0) {
 			// throw std::invalid_argument("Initial capacity cannot be zero.");
 			capacity_ = 1;
 		}
 
-        data = static_cast<T*>(std::malloc(capacity_ * sizeof(T)));
+        data_ = allocate(capacity_);
         head = tail = capacity_ / 2;
-#ifdef BIAS_MULT	
-		bias = 0.0f;
-#endif
-        
-        if (!data) {
-            throw std::bad_alloc();
-        }
     }
 
     // Rule of Five
 
     ~ShiftToMiddleArray() {
-        for (size_t i = head; i < tail; ++i) {
-            CLEANUP_ELEMENT_IF_NEEDED(&data[i], T);
-        }
-        std::free(data);
+        cleanup_all();
+        deallocate(data_, capacity_);
     }
 
 	ShiftToMiddleArray(const ShiftToMiddleArray& other)
-		:  head(other.head),
+		: ShiftToMiddleArray(other, alloc_traits::select_on_container_copy_construction(other.alloc_)) {}
+
+	ShiftToMiddleArray(const ShiftToMiddleArray& other, const Allocator& alloc)
+		: alloc_(alloc),
+		  data_(nullptr),
+		  head(other.head),
 		  tail(other.tail),
 		  capacity_(other.capacity_)
-#ifdef BIAS_MULT
 		  ,bias(other.bias)
-#endif		  
+		  ,drift(other.drift)
+		  ,demand(other.demand)
 	{
 		if (other.capacity_ > 0) {
-			data = static_cast<T*>(std::malloc(other.capacity_ * sizeof(T)));
-			if (!data) throw std::bad_alloc();
+			data_ = allocate(other.capacity_);
+			// A wrapped window is copied in its two parts into a contiguous one
+			const size_t first_end = other.wrapped ? other.capacity_ : other.tail;
+			const size_t second_end = other.wrapped ? other.tail : 0;
+			if (other.wrapped) {
+				head = (capacity_ - other.size()) / 2;
+				tail = head + other.size();
+			}
+			T* second = data_ + head + (first_end - other.head);
 			
 			if constexpr (std::is_trivially_copyable_v<T>) {
-				std::memcpy(data + head, other.data + other.head, (other.tail - other.head) * sizeof(T));
+				std::memcpy(data_ + head, other.data_ + other.head, (first_end - other.head) * sizeof(T));
+				if (second_end) std::memcpy(second, other.data_, second_end * sizeof(T));
 			} else {
 				try {
-					std::uninitialized_copy(other.data + other.head, other.data + other.tail, data + head);
+					copy_construct(other.data_ + other.head, other.data_ + first_end, data_ + head);
+					try {
+						copy_construct(other.data_, other.data_ + second_end, second);
+					} catch (...) {
+						for (T* p = data_ + head; p != second; ++p) alloc_traits::destroy(alloc_, p);
+						throw;
+					}
 				} catch (...) {
-					std::free(data);
+					deallocate(data_, capacity_);
 					throw;
 				}
 			}
-		} else {
-			data = nullptr;
 		}
 	}
 
 	ShiftToMiddleArray(ShiftToMiddleArray&& other) noexcept
-		: data(other.data),
+		: alloc_(std::move(other.alloc_)),
+		  bias(other.bias)
+		  ,drift(other.drift)
+		  ,demand(other.demand)
+	{
+		steal_storage(other);
+	}
+
+	// Steals other's block when the allocators are interchangeable, otherwise
+	// moves the elements one by one into storage owned by alloc.
+	ShiftToMiddleArray(ShiftToMiddleArray&& other, const Allocator& alloc)
+		: alloc_(alloc),
+		  data_(nullptr),
 		  head(other.head),
 		  tail(other.tail),
 		  capacity_(other.capacity_)
-#ifdef BIAS_MULT
 		  ,bias(other.bias)
-#endif		  		  
+		  ,drift(other.drift)
+		  ,demand(other.demand)
 	{
-		other.data = nullptr;
-		other.head = other.tail = other.capacity_ = 0;
+		if (alloc_ == other.alloc_) {
+			steal_storage(other);
+		} else if (capacity_ > 0) {
+			other.unwrap();
+			head = other.head;
+			tail = other.tail;
+			data_ = allocate(capacity_);
+			size_t i = head;
+			try {
+				for (; i < tail; ++i) alloc_traits::construct(alloc_, data_ + i, std::move(other.data_[i]));
+			} catch (...) {
+				while (i-- > head) alloc_traits::destroy(alloc_, data_ + i);
+				deallocate(data_, capacity_);
+				throw;
+			}
+		}
 	}
 
 	ShiftToMiddleArray& operator=(const ShiftToMiddleArray& other) {
 		if (this != &other) {
-			ShiftToMiddleArray temp(other);  // Use copy constructor
-			this->swap(temp);              // Swap with temporary
+			constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+			ShiftToMiddleArray temp(other, propagate ? other.alloc_ : alloc_);
+			swap_storage(temp);
+			if constexpr (propagate) {
+				using std::swap;
+				swap(alloc_, temp.alloc_);  // temp releases the old block with the old allocator
+			}
 		}
 		return *this;
 	}
 
-	ShiftToMiddleArray& operator=(ShiftToMiddleArray&& other) noexcept {
-		this->swap(other);
+	ShiftToMiddleArray& operator=(ShiftToMiddleArray&& other)
+		noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+		         alloc_traits::is_always_equal::value)
+	{
+		if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+			swap_storage(other);
+			using std::swap;
+			swap(alloc_, other.alloc_);
+		} else if (alloc_ == other.alloc_) {
+			swap_storage(other);
+		} else {
+			ShiftToMiddleArray temp(std::move(other), alloc_);
+			swap_storage(temp);
+		}
 		return *this;
 	}
 
+	allocator_type get_allocator() const noexcept { return alloc_; }
+
 	bool operator==(const ShiftToMiddleArray& other) const {
 		// Quick checks: size and capacity (if needed)
 		if (size() != other.size()) return false;
 		if (empty() && other.empty()) return true; // Both empty
 
-		// Compare each element in the active range [head, tail)
+		// Compare each element in the active range
 		for (size_t i = 0; i < size(); ++i) {
-			if (data[head + i] != other.data[other.head + i]) {
+			if (data_[slot_of(i)] != other.data_[other.slot_of(i)]) {
 				return false;
 			}
 		}
@@ -265,93 +1291,194 @@ public:
 	}
 
 	friend void swap(ShiftToMiddleArray& a, ShiftToMiddleArray& b) noexcept {
-		using std::swap;
-		swap(a.data, b.data);
-		swap(a.head, b.head);
-		swap(a.tail, b.tail);
-		swap(a.capacity_, b.capacity_);
-#ifdef BIAS_MULT	
-		swap(a.bias, b.bias);
-#endif
+		a.swap(b);
 	}
 
+	// Allocators are exchanged only when they propagate on swap; otherwise they
+	// must compare equal, as for the standard containers.
 	void swap(ShiftToMiddleArray& other) noexcept {
-		using std::swap;
-		swap(data, other.data);
-		swap(head, other.head);
-		swap(tail, other.tail);
-		swap(capacity_, other.capacity_);
-#ifdef BIAS_MULT
-		swap(bias, other.bias);
-#endif
+		swap_storage(other);
+		if constexpr (alloc_traits::propagate_on_container_swap::value) {
+			using std::swap;
+			swap(alloc_, other.alloc_);
+		}
 	}
 	
 	// Capacity observers
 
-    size_t size() const noexcept { return tail - head; }
-    bool empty() const noexcept { return head == tail; }
+    size_t size() const noexcept {
+		if constexpr (Policy::ring_wrap) {
+			if (wrapped) return capacity_ - head + tail;
+		}
+		return tail - head;
+	}
+
+    bool empty() const noexcept { return head == tail && !wrapped; }
     size_t capacity() const noexcept { return capacity_; }
 
+	// Free slots in front of the first / behind the last element. While wrapped,
+	// all free slots lie behind the last element.
+	size_t front_capacity() const noexcept { return wrapped ? 0 : head; }
+	size_t back_capacity() const noexcept { return wrapped ? head - tail : capacity_ - tail; }
+
+	// Ring mode (Policy::ring_wrap): whether the elements are in one piece, and a
+	// way to make them so. Without ring mode the array is always contiguous.
+	bool is_contiguous() const noexcept { return !wrapped; }
+	void make_contiguous() { unwrap(); }
+
+	// Headroom control. Each call guarantees at least n free slots on the named
+	// side (reserve: on both sides) with at most one reallocation, and never
+	// reduces the slack on the other side, so the following n pushes at that end
+	// cannot trigger a resize or a shift.
+
+	void reserve_front(size_t n) {
+		unwrap();
+		if (head >= n) return;
+		relayout(n + size() + (capacity_ - tail), n);
+	}
+
+	void reserve_back(size_t n) {
+		unwrap();
+		if (capacity_ - tail >= n) return;
+		relayout(head + size() + n, head);
+	}
+
+	void reserve(size_t n) {
+		unwrap();
+		if (head >= n && capacity_ - tail >= n) return;
+		const size_t front = std::max(head, n);
+		const size_t back = std::max(capacity_ - tail, n);
+		relayout(front + size() + back, front);
+	}
+
+	// Relocation counters since construction (Policy::collect_stats)
+	const stm::Stats& stats() const noexcept requires Policy::collect_stats { return counters; }
+	void reset_stats() noexcept requires Policy::collect_stats { counters = {}; }
+
 	// Accessors
 
     T& operator[](size_t  index) {
-        STM_ASSERT(index < size(), "Index out of range");
-        return data[head + index];
+        check(index < size(), "Index out of range");
+        return data_[slot_of(index)];
     }
 
     const T& operator[](size_t  index) const {
-        STM_ASSERT(index < size(), "Index out of range");
-        return data[head + index];
+        check(index < size(), "Index out of range");
+        return data_[slot_of(index)];
     }
 
     T& front() {
-        STM_ASSERT(!empty(), "Array is empty");
-        return data[head];
+        check(!empty(), "Array is empty");
+        return data_[head];
     }
 
     const T& front() const {
-        STM_ASSERT(!empty(), "Array is empty");
-        return data[head];
+        check(!empty(), "Array is empty");
+        return data_[head];
     }
 
     const T& get_head() const { return front(); }
 
     T& back() {
-        STM_ASSERT(!empty(), "Array is empty");
-        return data[tail - 1];
+        check(!empty(), "Array is empty");
+        return data_[slot_of(size() - 1)];
     }
 
     const T& back() const {
-        STM_ASSERT(!empty(), "Array is empty");
-        return data[tail - 1];
+        check(!empty(), "Array is empty");
+        return data_[slot_of(size() - 1)];
     }
 
+	// Zero-copy views of the first / last min(n, size()) elements, e.g. for
+	// handing a batch to write() before releasing it with pop_front_n/pop_back_n.
+	// While wrapped (ring mode) a view stops at the block edge and may be shorter;
+	// the remainder is available once the returned part has been popped.
+
+	std::span<T> front_span(size_t n) noexcept {
+		const size_t run = wrapped ? capacity_ - head : size();
+		return {data_ + head, std::min(n, run)};
+	}
+
+	std::span<const T> front_span(size_t n) const noexcept {
+		const size_t run = wrapped ? capacity_ - head : size();
+		return {data_ + head, std::min(n, run)};
+	}
+
+	std::span<T> back_span(size_t n) noexcept {
+		const size_t count = std::min(n, wrapped ? tail : size());
+		return {data_ + tail - count, count};
+	}
+
+	std::span<const T> back_span(size_t n) const noexcept {
+		const size_t count = std::min(n, wrapped ? tail : size());
+		return {data_ + tail - count, count};
+	}
+
     // Modifiers
 	
     void push_front(const T& value) {
-        if (head == 0) {
-#ifdef BIAS_MULT				
-			bias += BIAS_MULT;
-#endif
+        if (front_full() && in_block(std::addressof(value))) [[unlikely]] {
+            // value is one of our elements and is about to be moved: copy it first
+            push_front(T(value));
+            return;
+        }
+        demand.on_front(1);
+        unwrap();
+        if (head == 0) [[unlikely]] {
+			if constexpr (step_bias) bias += Policy::bias_step;
 			resize_if_needed();
 		}
-        new (&data[--head]) T(value);
+        alloc_traits::construct(alloc_, data_ + head - 1, value);
+        --head;
     }
 
-    void push_back(const T& value) {
-        if (tail == capacity_) {
-#ifdef BIAS_MULT				
-			bias -= BIAS_MULT;
-#endif
+    void push_front(T&& value) {
+        if (front_full() && in_block(std::addressof(value))) [[unlikely]] {
+            T taken(std::move(value));
+            push_front(std::move(taken));
+            return;
+        }
+        demand.on_front(1);
+        unwrap();
+        if (head == 0) [[unlikely]] {
+			if constexpr (step_bias) bias += Policy::bias_step;
 			resize_if_needed();
 		}
-        new (&data[tail++]) T(value);
+        alloc_traits::construct(alloc_, data_ + head - 1, std::move(value));
+        --head;
+    }
+
+    void push_back(const T& value) {
+        if (back_full() && in_block(std::addressof(value))) [[unlikely]] {
+            push_back(T(value));
+            return;
+        }
+        demand.on_back(1);
+        make_room_back();
+        alloc_traits::construct(alloc_, data_ + tail, value);
+        ++tail;
+    }
+
+    void push_back(T&& value) {
+        if (back_full() && in_block(std::addressof(value))) [[unlikely]] {
+            T taken(std::move(value));
+            push_back(std::move(taken));
+            return;
+        }
+        demand.on_back(1);
+        make_room_back();
+        alloc_traits::construct(alloc_, data_ + tail, std::move(value));
+        ++tail;
     }
 
     void push(const T& value) {
         push_back(value);
     }
 
+    void push(T&& value) {
+        push_back(std::move(value));
+    }
+
     void insert_tail(const T& value) {
         push_back(value);
     }
@@ -364,6 +1491,49 @@ public:
 		remove_tail();
 	}
 
+	// Remove the first / last min(n, size()) elements and return how many were
+	// removed. Elements that need no cleanup are released by moving head/tail
+	// alone; shrinking is considered once per call.
+	size_t pop_front_n(size_t n) {
+		n = std::min(n, size());
+		if (n == 0) return 0;
+		size_t rest = n;
+		if constexpr (Policy::ring_wrap) {
+			if (wrapped && rest >= capacity_ - head) {
+				// Consumes the whole first part: continue from the start of the block
+				cleanup_range(data_ + head, data_ + capacity_);
+				rest -= capacity_ - head;
+				head = 0;
+				wrapped = false;
+			}
+		}
+		cleanup_range(data_ + head, data_ + head + rest);
+		head += rest;
+		demand.on_front(-static_cast<std::ptrdiff_t>(n));
+		shrink_if_needed();
+		return n;
+	}
+
+	size_t pop_back_n(size_t n) {
+		n = std::min(n, size());
+		if (n == 0) return 0;
+		size_t rest = n;
+		if constexpr (Policy::ring_wrap) {
+			if (wrapped && rest >= tail) {
+				// Consumes the whole second part: continue from the end of the block
+				cleanup_range(data_, data_ + tail);
+				rest -= tail;
+				tail = capacity_;
+				wrapped = false;
+			}
+		}
+		cleanup_range(data_ + tail - rest, data_ + tail);
+		tail -= rest;
+		demand.on_back(-static_cast<std::ptrdiff_t>(n));
+		shrink_if_needed();
+		return n;
+	}
+
 	[[deprecated("pop(const T&) ignores its argument; use pop() or pop_back()")]]
     void pop(const T&) {
         pop_back();
@@ -376,24 +1546,145 @@ public:
     void remove_head() {
 		if (empty()) return;
         // Cleanup the element being removed if needed
-		CLEANUP_ELEMENT_IF_NEEDED(&data[head], T);
+		cleanup(&data_[head]);
 		++head;
-#ifdef ALLOW_SHRINKING
+		if constexpr (Policy::ring_wrap) {
+			// The first part of a wrapped window is used up: contiguous again
+			if (wrapped && head == capacity_) {
+				head = 0;
+				wrapped = false;
+			}
+		}
+		demand.on_front(-1);
 		shrink_if_needed();
-#endif		
     }
 
     void remove_tail() {
 		if (empty()) return;
+		if constexpr (Policy::ring_wrap) {
+			// Nothing left in the second part of a wrapped window
+			if (wrapped && tail == 0) {
+				tail = capacity_;
+				wrapped = false;
+			}
+		}
         // Cleanup the element being removed if needed
-		CLEANUP_ELEMENT_IF_NEEDED(&data[tail - 1], T);
+		cleanup(&data_[tail - 1]);
 		--tail;
-#ifdef ALLOW_SHRINKING
+		demand.on_back(-1);
 		shrink_if_needed();
-#endif		
     }
 
+	// Bulk modifiers
+	//
+	// Sized ranges (forward iterators or sized sentinels) reserve all the room they
+	// need with a single relayout and, for trivially copyable T read from contiguous
+	// memory, are copied with one memcpy. Single-pass input ranges fall back to
+	// element-wise growth. If an element constructor throws, a sized range leaves
+	// the previous contents; a single-pass range keeps what was appended so far.
+
+	template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+	void append_range(InputIt first, Sentinel last) {
+		if (range_in_block(first, last)) {
+			// The range is part of this array, which may move: copy it out first
+			ShiftToMiddleArray buffered(alloc_);
+			buffered.append_range(std::move(first), std::move(last));
+			append_range(std::make_move_iterator(buffered.begin()), std::make_move_iterator(buffered.end()));
+			return;
+		}
+		unwrap();
+		if constexpr (std::sized_sentinel_for<Sentinel, InputIt> || std::forward_iterator<InputIt>) {
+			const size_t n = static_cast<size_t>(std::ranges::distance(first, last));
+			if (capacity_ - tail < n) grow_back(n);
+			construct_range(std::move(first), n, data_ + tail);
+			tail += n;
+		} else {
+			for (; first != last; ++first) {
+				if (tail == capacity_) grow_back(1);
+				alloc_traits::construct(alloc_, data_ + tail, *first);
+				++tail;
+			}
+		}
+	}
+
+	template <std::ranges::input_range R>
+	void append_range(R&& range) {
+		append_range(std::ranges::begin(range), std::ranges::end(range));
+	}
+
+	// Inserts the range in front of head, keeping the source order.
+	template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+	void prepend_range(InputIt first, Sentinel last) {
+		if (range_in_block(first, last)) {
+			// The range is part of this array, which may move: copy it out first
+			ShiftToMiddleArray buffered(alloc_);
+			buffered.append_range(std::move(first), std::move(last));
+			prepend_range(std::make_move_iterator(buffered.begin()), std::make_move_iterator(buffered.end()));
+			return;
+		}
+		unwrap();
+		if constexpr (std::sized_sentinel_for<Sentinel, InputIt> || std::forward_iterator<InputIt>) {
+			const size_t n = static_cast<size_t>(std::ranges::distance(first, last));
+			if (head < n) grow_front(n);
+			construct_range(std::move(first), n, data_ + head - n);
+			head -= n;
+		} else {
+			// Single pass: buffer first so the elements can be placed in order
+			ShiftToMiddleArray buffered(alloc_);
+			buffered.append_range(std::move(first), std::move(last));
+			prepend_range(std::make_move_iterator(buffered.begin()), std::make_move_iterator(buffered.end()));
+		}
+	}
+
+	template <std::ranges::input_range R>
+	void prepend_range(R&& range) {
+		prepend_range(std::ranges::begin(range), std::ranges::end(range));
+	}
+
+	// Replaces the contents; the existing block is reused when it is large enough.
+	template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+	void assign(InputIt first, Sentinel last) {
+		clear();
+		if constexpr (std::sized_sentinel_for<Sentinel, InputIt> || std::forward_iterator<InputIt>) {
+			const size_t n = static_cast<size_t>(std::ranges::distance(first, last));
+			if (n <= capacity_) head = tail = (capacity_ - n) / 4;
+		}
+		append_range(std::move(first), std::move(last));
+	}
+
+	template <std::ranges::input_range R>
+	void assign_range(R&& range) {
+		assign(std::ranges::begin(range), std::ranges::end(range));
+	}
+
+	void assign(std::initializer_list<T> values) {
+		assign(values.begin(), values.end());
+	}
+
+	void assign(size_t count, const T& value) {
+		clear();
+		if (count <= capacity_) head = tail = (capacity_ - count) / 4;
+		else grow_back(count);
+		for (size_t i = 0; i < count; ++i) {
+			alloc_traits::construct(alloc_, data_ + tail, value);
+			++tail;
+		}
+	}
+
+	void clear() noexcept {
+		cleanup_all();
+		head = tail = capacity_ / 2;
+		wrapped = {};
+	}
+
     void insert(size_t  at, const T& value) {
+		if (in_block(std::addressof(value))) {
+			// value is one of our elements and may be moved by the shift: copy it first
+			const T copy(value);
+			insert(at, copy);
+			return;
+		}
+		unwrap();
 		if (at > size()) {
             throw std::out_of_range("Insert position out of range");
         }
@@ -404,71 +1695,162 @@ public:
             if (head == 0) resize_if_needed();
             --head;
 			absolute_at = head + at;
-            if constexpr (std::is_trivially_copyable_v<T>) {
-                std::memmove(data + head, data + head + 1, (absolute_at - head) * sizeof(T));
-                data[absolute_at] = value;
-            } else {
-                for (size_t i = head; i < absolute_at; ++i) {
-                    new (&data[i]) T(std::move(data[i + 1]));
-                    data[i + 1].~T();
-                }
-                new (&data[absolute_at]) T(value);
-            }
+            relocate_overlapping(data_ + head + 1, data_ + absolute_at + 1, data_ + head);
+            alloc_traits::construct(alloc_, data_ + absolute_at, value);
         } else {
             if (tail == capacity_) resize_if_needed();
 			absolute_at = head + at;
-            if constexpr (std::is_trivially_copyable_v<T>) {
-                std::memmove(data + absolute_at + 1, data + absolute_at, (tail - absolute_at) * sizeof(T));
-                data[absolute_at] = value;
-            } else {
-                for (size_t i = tail; i > absolute_at; --i) {
-                    new (&data[i]) T(std::move(data[i - 1]));
-                    data[i - 1].~T();
-                }
-                new (&data[absolute_at]) T(value);
-            }
+            relocate_overlapping(data_ + absolute_at, data_ + tail, data_ + absolute_at + 1);
+            alloc_traits::construct(alloc_, data_ + absolute_at, value);
             ++tail;
         }
     }
 
 	void delete_at(size_t index) {
-		STM_ASSERT(index < size(), "ShiftToMiddleArray::delete_at index out of range");
+		unwrap();
+		check(index < size(), "ShiftToMiddleArray::delete_at index out of range");
 		
 		size_t absolute_pos = head + index;
 		bool closer_to_head = (index < size() / 2);
 		
 		// Destroy target element
 		if constexpr (!std::is_trivially_destructible_v<T>) {
-			data[absolute_pos].~T();
+			alloc_traits::destroy(alloc_, data_ + absolute_pos);
 		}
 		
 		// Shift elements (direction-aware)
 		if (closer_to_head) {
-			if constexpr (std::is_trivially_copyable_v<T>) {
-				std::memmove(data + head + 1, data + head, index * sizeof(T));
-			} else {
-				for (size_t i = absolute_pos; i > head; --i) {
-					new (&data[i]) T(std::move(data[i - 1]));
-					data[i - 1].~T();
-				}
-			}
+			relocate_overlapping(data_ + head, data_ + absolute_pos, data_ + head + 1);
 			++head;
 		} else {
-			if constexpr (std::is_trivially_copyable_v<T>) {
-				std::memmove(data + absolute_pos, data + absolute_pos + 1, 
-							(tail - absolute_pos - 1) * sizeof(T));
-			} else {
-				for (size_t i = absolute_pos; i < tail - 1; ++i) {
-					new (&data[i]) T(std::move(data[i + 1]));
-					data[i + 1].~T();
-				}
-			}
+			relocate_overlapping(data_ + absolute_pos + 1, data_ + tail, data_ + absolute_pos);
 			--tail;
 		}
 		
-#ifdef ALLOW_SHRINKING
 		shrink_if_needed();
-#endif
+	}
+
+	// Range insert and erase in the middle: one shift of the shorter side, at
+	// most one growth. Positions are indices as for insert()/delete_at(); the
+	// iterator overloads below follow the std::vector signatures. The value or
+	// range may come from this array; it is copied out before anything moves. If
+	// constructing an inserted element throws, the gap is closed again and the
+	// previous contents remain.
+
+	void insert(size_t at, size_t count, const T& value) {
+		if (count != 0 && in_block(std::addressof(value))) {
+			// value is one of our elements and may be moved by the shift: copy it first
+			const T copy(value);
+			insert(at, count, copy);
+			return;
+		}
+		unwrap();
+		if (at > size()) {
+			throw std::out_of_range("Insert position out of range");
+		}
+		if (count == 0) return;
+		const size_t pos = open_gap(at, count);
+		size_t i = 0;
+		try {
+			for (; i < count; ++i) alloc_traits::construct(alloc_, data_ + pos + i, value);
+		} catch (...) {
+			for (size_t j = 0; j < i; ++j) alloc_traits::destroy(alloc_, data_ + pos + j);
+			close_gap(pos, count);
+			throw;
+		}
+	}
+
+	template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+	void insert(size_t at, InputIt first, Sentinel last) {
+		if (range_in_block(first, last)) {
+			// The range is part of this array, which may move: copy it out first
+			ShiftToMiddleArray buffered(alloc_);
+			buffered.append_range(std::move(first), std::move(last));
+			insert(at, std::make_move_iterator(buffered.begin()), std::make_move_iterator(buffered.end()));
+			return;
+		}
+		unwrap();
+		if (at > size()) {
+			throw std::out_of_range("Insert position out of range");
+		}
+		if constexpr (std::sized_sentinel_for<Sentinel, InputIt> || std::forward_iterator<InputIt>) {
+			const size_t n = static_cast<size_t>(std::ranges::distance(first, last));
+			if (n == 0) return;
+			const size_t pos = open_gap(at, n);
+			try {
+				construct_range(std::move(first), n, data_ + pos);
+			} catch (...) {
+				close_gap(pos, n);
+				throw;
+			}
+		} else {
+			// Single pass: buffer first so the size is known before shifting
+			ShiftToMiddleArray buffered(alloc_);
+			buffered.append_range(std::move(first), std::move(last));
+			insert(at, std::make_move_iterator(buffered.begin()), std::make_move_iterator(buffered.end()));
+		}
+	}
+
+	template <std::ranges::input_range R>
+	void insert_range(size_t at, R&& range) {
+		insert(at, std::ranges::begin(range), std::ranges::end(range));
+	}
+
+	// Removes the elements at positions [first, last)
+	void erase(size_t first, size_t last) {
+		unwrap();
+		check(first <= last && last <= size(), "ShiftToMiddleArray::erase range out of range");
+		if (first == last) return;
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			for (size_t i = first; i < last; ++i) alloc_traits::destroy(alloc_, data_ + head + i);
+		}
+		close_gap(head + first, last - first);
+		shrink_if_needed();
+	}
+
+	// Removes every element for which pred returns true, in one pass, and
+	// returns how many were removed. pred is called once per element. Survivors
+	// keep their order; only the elements between the first and the last removed
+	// one and the shorter outer run are moved.
+	template <typename Pred>
+	size_t erase_if(Pred pred) {
+		unwrap();
+		T* first = data_ + head;
+		T* const end = data_ + tail;
+		while (first != end && !pred(std::as_const(*first))) ++first;
+		if (first == end) return 0;
+		T* back = end - 1;
+		while (back != first && !pred(std::as_const(*back))) --back;
+
+		const size_t before = size();
+		compact(first, back, [&pred](const T* in, const T*) { return static_cast<bool>(pred(*in)); });
+		shrink_if_needed();
+		return before - size();
+	}
+
+	// Removes every element equal to the one before it (as std::unique, but the
+	// removed elements are gone rather than left at the end), and returns how many
+	// were removed.
+	template <typename BinaryPred = std::equal_to<>>
+	size_t unique(BinaryPred equal = BinaryPred()) {
+		unwrap();
+		if (size() < 2) return 0;
+		T* const begin = data_ + head;
+		T* const end = data_ + tail;
+		T* first = begin + 1;
+		while (first != end && !equal(std::as_const(first[-1]), std::as_const(*first))) ++first;
+		if (first == end) return 0;
+		T* back = end - 1;
+		while (back != first && !equal(std::as_const(back[-1]), std::as_const(*back))) --back;
+
+		// Compacting forwards (out < in) the predecessor may already have moved, so
+		// compare with the last kept element; for an equivalence that is the same.
+		const size_t before = size();
+		compact(first, back, [&equal](const T* in, const T* out) {
+			return static_cast<bool>(out < in ? equal(out[-1], *in) : equal(in[-1], *in));
+		});
+		shrink_if_needed();
+		return before - size();
 	}
 
     // Iterator System
@@ -476,11 +1858,16 @@ public:
     template <bool Const>
     class IteratorBase {
         using ptr_t = std::conditional_t<Const, const T*, T*>;
-        ptr_t ptr;
+        ptr_t ptr = nullptr;
     public:
+        IteratorBase() = default;
         explicit IteratorBase(ptr_t p) : ptr(p) {}
+        template <bool C = Const> requires C
+        IteratorBase(const IteratorBase<false>& other) : ptr(other.operator->()) {}
         using iterator_category = std::random_access_iterator_tag;
+        using iterator_concept = std::contiguous_iterator_tag;
         using value_type = T;
+        using element_type = std::conditional_t<Const, const T, T>;
         using difference_type = std::ptrdiff_t;
         using pointer = ptr_t;
         using reference = std::conditional_t<Const, const T&, T&>;
@@ -513,51 +1900,134 @@ public:
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-    iterator begin() { return iterator(data + head); }
-    iterator end()   { return iterator(data + tail); }
-    const_iterator begin() const { return const_iterator(data + head); }
-    const_iterator end() const   { return const_iterator(data + tail); }
-    const_iterator cbegin() const { return begin(); }
-    const_iterator cend() const   { return end(); }
+    // In ring mode, asking for iterators or data() restores a contiguous layout
+    // first. A const member cannot do that, so the const iterator and data()
+    // overloads do not exist in ring mode; use operator[], front_span()/back_span()
+    // or the non-const members.
+
+    iterator begin() { unwrap(); return iterator(data_ + head); }
+    iterator end()   { unwrap(); return iterator(data_ + tail); }
+    const_iterator begin() const requires (!Policy::ring_wrap) { return const_iterator(data_ + head); }
+    const_iterator end() const requires (!Policy::ring_wrap)   { return const_iterator(data_ + tail); }
+    const_iterator cbegin() const requires (!Policy::ring_wrap) { return begin(); }
+    const_iterator cend() const requires (!Policy::ring_wrap)   { return end(); }
 
     reverse_iterator rbegin() { return reverse_iterator(end()); }
     reverse_iterator rend()   { return reverse_iterator(begin()); }
-    const_reverse_iterator crbegin() const { return const_reverse_iterator(cend()); }
-    const_reverse_iterator crend() const   { return const_reverse_iterator(cbegin()); }
+    const_reverse_iterator crbegin() const requires (!Policy::ring_wrap) { return const_reverse_iterator(cend()); }
+    const_reverse_iterator crend() const requires (!Policy::ring_wrap)   { return const_reverse_iterator(cbegin()); }
+
+	// Iterator forms of the range insert/erase; each returns an iterator to the
+	// first inserted element, or to the element after the erased ones.
+
+	iterator insert(const_iterator pos, size_t count, const T& value) {
+		const size_t at = static_cast<size_t>(pos - const_iterator(data_ + head));
+		insert(at, count, value);
+		return begin() + static_cast<std::ptrdiff_t>(at);
+	}
+
+	template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+	iterator insert(const_iterator pos, InputIt first, Sentinel last) {
+		const size_t at = static_cast<size_t>(pos - const_iterator(data_ + head));
+		insert(at, std::move(first), std::move(last));
+		return begin() + static_cast<std::ptrdiff_t>(at);
+	}
+
+	iterator erase(const_iterator first, const_iterator last) {
+		const size_t at = static_cast<size_t>(first - const_iterator(data_ + head));
+		erase(at, static_cast<size_t>(last - const_iterator(data_ + head)));
+		return begin() + static_cast<std::ptrdiff_t>(at);
+	}
+
+	iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+	// Contiguous storage of the elements, as for std::vector::data()
+	T* data() { unwrap(); return data_ + head; }
+	const T* data() const requires (!Policy::ring_wrap) { return data_ + head; }
+
+	// Search and reductions over the window, vectorized for arithmetic T (see
+	// SimdKernels.h) and plain loops otherwise. They run over the window as it
+	// is, in two runs when it wraps; only the non-const find/lower_bound unwrap,
+	// to form the returned iterator.
+
+	iterator find(const T& value) { return begin() + static_cast<std::ptrdiff_t>(find_index(value)); }
+	const_iterator find(const T& value) const requires (!Policy::ring_wrap) { return cbegin() + static_cast<std::ptrdiff_t>(find_index(value)); }
+
+	size_t count(const T& value) const {
+		const std::span<const T> a = first_run();
+		const std::span<const T> b = second_run();
+		return stm::simd::count(a.data(), a.data() + a.size(), value) + stm::simd::count(b.data(), b.data() + b.size(), value);
+	}
+
+	bool contains(const T& value) const { return find_index(value) != size(); }
+
+	// Sum in T, starting from T{}; floating-point sums round differently from a
+	// left-to-right loop
+	T sum() const {
+		const std::span<const T> a = first_run();
+		const std::span<const T> b = second_run();
+		if (b.empty()) return stm::simd::sum(a.data(), a.data() + a.size());
+		return stm::simd::sum(a.data(), a.data() + a.size()) + stm::simd::sum(b.data(), b.data() + b.size());
+	}
+
+	// Smallest / largest element, the first one on ties
+	const T& min() const {
+		check(!empty(), "Array is empty");
+		return extreme<false>();
+	}
+
+	const T& max() const {
+		check(!empty(), "Array is empty");
+		return extreme<true>();
+	}
+
+	// First element not less than value; the elements must be sorted
+	iterator lower_bound(const T& value) { return begin() + static_cast<std::ptrdiff_t>(lower_bound_index(value)); }
+	const_iterator lower_bound(const T& value) const requires (!Policy::ring_wrap) { return cbegin() + static_cast<std::ptrdiff_t>(lower_bound_index(value)); }
 
 	// Other methods
 
     void shrink_to_fit() {
+		unwrap();
+		if (is_inline(data_)) return;  // the inline buffer costs nothing extra
+		if constexpr (release_pages) {
+			release_unused_pages();
+			return;
+		}
         size_t new_capacity = size();
 		if (new_capacity == 0) {
 			new_capacity = 1;
 		}
-        T* new_data = static_cast<T*>(std::malloc(new_capacity * sizeof(T)));
-        if (!new_data) throw std::bad_alloc();
+        T* new_data = allocate(new_capacity);
 
-		if constexpr (std::is_trivially_copyable_v<T>) {
-			std::memcpy(new_data, data + head, (tail - head) * sizeof(T));
-		} else {
-			std::uninitialized_copy(data + head, data + tail, new_data);
-			for (size_t i = head; i < tail; ++i) {
-				data[i].~T();
-			}
+		try {
+			relocate(data_ + head, data_ + tail, new_data);
+		} catch (...) {
+			deallocate(new_data, new_capacity);
+			throw;
 		}
-        std::free(data);
-        data = new_data;
+        deallocate(data_, capacity_);
+        data_ = new_data;
+        counters.reallocated();
         tail -= head;
         head = 0;
         capacity_ = new_capacity;
     }
 
 	void serialize(std::ostream& os) const {
-		os.write(reinterpret_cast<const char*>(&head), sizeof(size_t));
 		size_t current_size = size(); // Store size to avoid recalculating
+		// A wrapped window is written as if unwrapped, centered in the block
+		const size_t saved_head = wrapped ? (capacity_ - current_size) / 2 : head;
+		os.write(reinterpret_cast<const char*>(&saved_head), sizeof(size_t));
 		os.write(reinterpret_cast<const char*>(&current_size), sizeof(size_t));
-		os.write(reinterpret_cast<const char*>(data + head), current_size * sizeof(T));
+		const std::span<const T> a = first_run();
+		const std::span<const T> b = second_run();
+		os.write(reinterpret_cast<const char*>(a.data()), a.size() * sizeof(T));
+		os.write(reinterpret_cast<const char*>(b.data()), b.size() * sizeof(T));
 	}
 
 	bool deserialize(std::istream& is) {
+		unwrap();
 		size_t new_head = 0;
 		size_t serialized_size = 0;
 
@@ -576,7 +2046,7 @@ public:
 		}
 
 		// Read data into buffer
-		is.read(reinterpret_cast<char*>(data + new_head), serialized_size * sizeof(T));
+		is.read(reinterpret_cast<char*>(data_ + new_head), serialized_size * sizeof(T));
 		if (is.fail()) {
 			return false;
 		}
@@ -588,7 +2058,21 @@ public:
 	}
 };
 
-template<typename T>
-void swap(ShiftToMiddleArray<T>& lhs, ShiftToMiddleArray<T>& rhs) noexcept {
+template <typename T, size_t ResizeMult, typename Allocator, typename Policy>
+void swap(ShiftToMiddleArray<T, ResizeMult, Allocator, Policy>& lhs, ShiftToMiddleArray<T, ResizeMult, Allocator, Policy>& rhs) noexcept {
 	lhs.swap(rhs);
 }
+
+// ShiftToMiddleArray that keeps up to N elements inside the object and only
+// allocates once it grows past them, e.g. for many mostly tiny queues.
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename Policy = stm::DefaultPolicy>
+using SmallShiftToMiddleArray = ShiftToMiddleArray<T, 2, Allocator, stm::InlinePolicy<N, Policy>>;
+
+namespace stm::pmr {
+
+// ShiftToMiddleArray drawing its storage from a std::pmr::memory_resource,
+// e.g. a per-request std::pmr::monotonic_buffer_resource.
+template <typename T, size_t ResizeMult = 2, typename Policy = DefaultPolicy>
+using ShiftToMiddleArray = ::ShiftToMiddleArray<T, ResizeMult, std::pmr::polymorphic_allocator<T>, Policy>;
+
+} // namespace stm::pmr
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>    // std::min, std::max
+#include <atomic>       // std::atomic, wait/notify
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint32_t, SIZE_MAX
+#include <iterator>     // std::input_iterator, std::output_iterator
+#include <memory>       // std::allocator
+#include <mutex>        // std::mutex, std::unique_lock
+#include <optional>     // std::optional
+#include <span>         // std::span
+#include <utility>      // std::forward, std::move
+
+#include "ShiftToMiddleArray.h"
+
+// Bounded multi-producer, multi-consumer channel over a ShiftToMiddleArray.
+//
+// Backpressure works with two watermarks. Once the channel holds high_watermark
+// elements, producers block, and they stay blocked until consumers have drained
+// it down to low_watermark. The gap keeps a full channel from waking a producer
+// for every single pop.
+//
+// The array is guarded by a std::mutex, which costs no syscall while
+// uncontended. Blocked threads sleep on atomic sequence counters through
+// std::atomic::wait, which is a futex wait on Linux. A push or pop makes a
+// wake-up call only when it releases a thread that is asleep and not yet
+// signalled: a push into an empty channel with consumers waiting, or the pop
+// that lifts the throttle.
+//
+// close() ends the input. Later pushes fail, and blocked producers return.
+// Consumers keep receiving what is already queued; once the channel is
+// drained, their pops return nothing instead of blocking.
+template <typename T, typename Policy = stm::DefaultPolicy>
+class ShiftToMiddleChannel {
+	using Array = ShiftToMiddleArray<T, 2, std::allocator<T>, Policy>;
+
+	mutable std::mutex mutex_;
+	Array buffer_;
+	size_t high_;
+	size_t low_;
+	bool throttled_ = false;  // reached high_, not yet drained to low_
+	bool closed_ = false;
+
+	// Threads blocked on one condition (room, or elements). They sleep on seq
+	// until a waker bumps it; sleeping and signalled are guarded by the mutex.
+	// A woken thread stays counted until it has reacquired the mutex, so wakers
+	// only signal sleepers not already signalled: a burst of pushes into a
+	// channel with one sleeping consumer costs one futex wake, not one each.
+	struct Sleepers {
+		std::atomic<std::uint32_t> seq{0};
+		size_t sleeping = 0;
+		size_t signalled = 0;
+
+		// Called with the mutex held, returns with it held
+		void sleep(std::unique_lock<std::mutex>& lock) {
+			const std::uint32_t seen = seq.load(std::memory_order_relaxed);
+			++sleeping;
+			lock.unlock();
+			seq.wait(seen, std::memory_order_acquire);
+			lock.lock();
+			--sleeping;
+			if (signalled > 0) --signalled;
+		}
+
+		// Releases up to n sleepers (SIZE_MAX: all of them)
+		void wake(size_t n) noexcept {
+			n = std::min(n, sleeping - signalled);
+			if (n == 0) return;
+			signalled += n;
+			seq.fetch_add(1, std::memory_order_release);
+			if (n == 1) seq.notify_one();
+			else seq.notify_all();
+		}
+	};
+
+	Sleepers producers_;
+	Sleepers consumers_;
+
+	bool full() const noexcept { return throttled_ || buffer_.size() >= high_; }
+
+	// After adding n elements: engage the throttle at the high watermark and
+	// release a consumer per element
+	void added(size_t n) noexcept {
+		if (buffer_.size() >= high_) throttled_ = true;
+		consumers_.wake(n);
+	}
+
+	// After removing elements: release the throttle at the low watermark and,
+	// with it, every producer it held back
+	void removed() noexcept {
+		if (throttled_ && buffer_.size() <= low_) {
+			throttled_ = false;
+			producers_.wake(SIZE_MAX);
+		}
+	}
+
+	// Blocks until there is room or the channel is closed; false if closed
+	bool wait_for_space(std::unique_lock<std::mutex>& lock) {
+		while (full() && !closed_) producers_.sleep(lock);
+		return !closed_;
+	}
+
+	// Blocks until there is an element or the channel is closed and drained
+	bool wait_for_items(std::unique_lock<std::mutex>& lock) {
+		while (buffer_.empty() && !closed_) consumers_.sleep(lock);
+		return !buffer_.empty();
+	}
+
+	template <typename U>
+	bool push_one(U&& value) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (!wait_for_space(lock)) return false;
+		buffer_.push_back(std::forward<U>(value));
+		added(1);
+		return true;
+	}
+
+	template <std::output_iterator<T&&> OutputIt>
+	size_t take(OutputIt& out, size_t max) {
+		size_t taken = 0;
+		while (taken < max && !buffer_.empty()) {
+			std::span<T> run = buffer_.front_span(max - taken);
+			out = std::move(run.begin(), run.end(), out);
+			buffer_.pop_front_n(run.size());
+			taken += run.size();
+		}
+		return taken;
+	}
+
+public:
+	using value_type = T;
+
+	// Producers block at high_watermark elements until the channel is drained
+	// to low_watermark (default: half of high_watermark)
+	explicit ShiftToMiddleChannel(size_t high_watermark, size_t low_watermark)
+		: buffer_(std::max<size_t>(high_watermark, 1)), high_(std::max<size_t>(high_watermark, 1)),
+		  low_(std::min(low_watermark, high_ - 1)) {}
+
+	explicit ShiftToMiddleChannel(size_t high_watermark = 1024)
+		: ShiftToMiddleChannel(high_watermark, high_watermark / 2) {}
+
+	ShiftToMiddleChannel(const ShiftToMiddleChannel&) = delete;
+	ShiftToMiddleChannel& operator=(const ShiftToMiddleChannel&) = delete;
+
+	// Producers
+
+	// Blocks while the channel is throttled. False (value not queued) once closed.
+	bool push(const T& value) { return push_one(value); }
+	bool push(T&& value) { return push_one(std::move(value)); }
+
+	// Never blocks: false if the channel is throttled or closed
+	bool try_push(const T& value) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (full() || closed_) return false;
+		buffer_.push_back(value);
+		added(1);
+		return true;
+	}
+
+	// Queues n elements from first, taking the lock once per stretch that fits
+	// below the high watermark and blocking in between. Returns how many were
+	// queued: n, or fewer if the channel was closed meanwhile. If copying an
+	// element throws, the ones before it stay queued and are signalled.
+	template <std::input_iterator InputIt>
+	size_t push_batch(InputIt first, size_t n) {
+		size_t pushed = 0;
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (pushed < n) {
+			if (!wait_for_space(lock)) break;
+			const size_t room = std::min(n - pushed, high_ - buffer_.size());
+			size_t i = 0;
+			try {
+				for (; i < room; ++i, ++first) buffer_.push_back(*first);
+			} catch (...) {
+				added(i);
+				throw;
+			}
+			pushed += room;
+			added(room);
+		}
+		return pushed;
+	}
+
+	size_t push_batch(std::span<const T> values) { return push_batch(values.begin(), values.size()); }
+
+	// Consumers
+
+	// Blocks until an element arrives; nothing once the channel is closed and drained
+	std::optional<T> pop() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (!wait_for_items(lock)) return std::nullopt;
+		std::optional<T> value(std::move(buffer_.front()));
+		buffer_.pop_front();
+		removed();
+		return value;
+	}
+
+	std::optional<T> try_pop() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (buffer_.empty()) return std::nullopt;
+		std::optional<T> value(std::move(buffer_.front()));
+		buffer_.pop_front();
+		removed();
+		return value;
+	}
+
+	// Blocks until at least one element is queued, then moves up to max of them
+	// to out. Returns how many; 0 only once the channel is closed and drained.
+	template <std::output_iterator<T&&> OutputIt>
+	size_t pop_batch(OutputIt out, size_t max) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (max == 0 || !wait_for_items(lock)) return 0;
+		const size_t taken = take(out, max);
+		removed();
+		return taken;
+	}
+
+	template <std::output_iterator<T&&> OutputIt>
+	size_t try_pop_batch(OutputIt out, size_t max) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		const size_t taken = take(out, max);
+		if (taken > 0) removed();
+		return taken;
+	}
+
+	// Ends the input and wakes every blocked thread. Idempotent.
+	void close() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (closed_) return;
+		closed_ = true;
+		producers_.wake(SIZE_MAX);
+		consumers_.wake(SIZE_MAX);
+	}
+
+	// Snapshots; other threads may change them right after
+
+	bool closed() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return closed_;
+	}
+
+	size_t size() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return buffer_.size();
+	}
+
+	size_t high_watermark() const noexcept { return high_; }
+	size_t low_watermark() const noexcept { return low_; }
+};
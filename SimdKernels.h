@@ -0,0 +1,334 @@
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <cstring>      // std::memcpy
+#include <type_traits>  // std::is_arithmetic_v
+
+// Search and reduction kernels over a contiguous range, used by the
+// ShiftToMiddleArray members find(), count(), contains(), sum(), min(), max()
+// and lower_bound().
+//
+// For arithmetic element types each kernel has an AVX2 and an AVX-512 build,
+// chosen at run time from the CPU (one cpuid check per process), and a scalar
+// version for everything else. The vector kernels are written once with the
+// GCC/Clang vector extensions and compiled per instruction set through target
+// attributes, so nothing needs -mavx2 and the binary still runs on older CPUs.
+// Define STM_NO_SIMD to always use the scalar versions.
+//
+// Results match the std:: algorithms with two exceptions: sum() adds in a
+// different order (floating-point rounding may differ), and min()/max() of a
+// range containing NaN are unspecified.
+
+#if !defined(STM_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define STM_SIMD_X86 1
+#else
+#define STM_SIMD_X86 0
+#endif
+
+#if STM_SIMD_X86
+#define STM_TARGET_AVX2 __attribute__((target("avx2")))
+#define STM_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#endif
+
+namespace stm::simd {
+
+enum class Isa { Scalar, Avx2, Avx512 };
+
+// The widest instruction set the kernels can use on this CPU
+inline Isa detected_isa() noexcept {
+#if STM_SIMD_X86
+	static const Isa isa = __builtin_cpu_supports("avx512bw") ? Isa::Avx512
+	                     : __builtin_cpu_supports("avx2") ? Isa::Avx2
+	                     : Isa::Scalar;
+	return isa;
+#else
+	return Isa::Scalar;
+#endif
+}
+
+// Element types the vector kernels handle (integers and floating point, not bool)
+template <typename T>
+inline constexpr bool vectorizable_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                                       (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+// Scalar versions; also the reference for the vector ones
+
+template <typename T>
+const T* find_scalar(const T* first, const T* last, const T& value) {
+	for (; first != last; ++first) {
+		if (*first == value) return first;
+	}
+	return last;
+}
+
+template <typename T>
+size_t count_scalar(const T* first, const T* last, const T& value) {
+	size_t n = 0;
+	for (; first != last; ++first) n += (*first == value);
+	return n;
+}
+
+template <typename T>
+T sum_scalar(const T* first, const T* last) {
+	T acc{};
+	for (; first != last; ++first) acc = acc + *first;
+	return acc;
+}
+
+// Smallest (Max = false) or largest element of a non-empty range
+template <bool Max, typename T>
+const T* extreme_scalar(const T* first, const T* last) {
+	const T* best = first;
+	for (++first; first < last; ++first) {
+		if (Max ? *best < *first : *first < *best) best = first;
+	}
+	return best;
+}
+
+// Branchless binary search: the probe decides the next base with a
+// conditional move instead of a hard-to-predict branch.
+template <typename T>
+const T* lower_bound_scalar(const T* first, const T* last, const T& value) {
+	size_t n = static_cast<size_t>(last - first);
+	while (n > 1) {
+		const size_t half = n / 2;
+		first = first[half - 1] < value ? first + half : first;
+		n -= half;
+	}
+	return first + (n == 1 && *first < value);
+}
+
+#if STM_SIMD_X86
+
+namespace detail {
+
+// The kernel bodies, instantiated once per vector width. They must be inlined
+// into a function carrying the matching target attribute.
+template <typename T, size_t Bytes>
+struct Kernels {
+	typedef T vec __attribute__((vector_size(Bytes)));
+	static constexpr size_t lanes = Bytes / sizeof(T);
+
+	// Helpers take vectors by reference: a vector passed by value through a
+	// function built without AVX would change the calling convention.
+	static inline __attribute__((always_inline)) void load(vec& v, const T* p) {
+		std::memcpy(&v, p, Bytes);
+	}
+
+	static inline __attribute__((always_inline)) void splat(vec& v, T x) {
+		v = vec{} + x;
+	}
+
+	template <typename M>
+	static inline __attribute__((always_inline)) bool any(const M& mask) {
+		std::uint64_t parts[Bytes / 8];
+		std::memcpy(parts, &mask, Bytes);
+		std::uint64_t bits = 0;
+		for (size_t i = 0; i < Bytes / 8; ++i) bits |= parts[i];
+		return bits != 0;
+	}
+
+	static inline __attribute__((always_inline)) const T* find(const T* first, const T* last, T value) {
+		vec needle, v0, v1;
+		splat(needle, value);
+		for (; static_cast<size_t>(last - first) >= 2 * lanes; first += 2 * lanes) {
+			load(v0, first);
+			load(v1, first + lanes);
+			if (any(v0 == needle) || any(v1 == needle)) break;
+		}
+		return find_scalar(first, last, value);  // at most two vectors, plus the tail
+	}
+
+	static inline __attribute__((always_inline)) size_t count(const T* first, const T* last, T value) {
+		vec needle, v;
+		splat(needle, value);
+		using mask = decltype(needle == needle);
+		// Lane counters are as wide as T: flush them before they can overflow
+		constexpr size_t flush = sizeof(T) == 1 ? 127 : sizeof(T) == 2 ? 32767 : size_t(1) << 30;
+		size_t n = 0;
+		while (static_cast<size_t>(last - first) >= lanes) {
+			mask acc = {};
+			for (size_t i = 0; i < flush && static_cast<size_t>(last - first) >= lanes; ++i, first += lanes) {
+				load(v, first);
+				acc -= (v == needle);
+			}
+			for (size_t i = 0; i < lanes; ++i) n += static_cast<size_t>(acc[i]);
+		}
+		return n + count_scalar(first, last, value);
+	}
+
+	static inline __attribute__((always_inline)) T sum(const T* first, const T* last) {
+		vec acc0 = {}, acc1 = {}, v0, v1;
+		for (; static_cast<size_t>(last - first) >= 2 * lanes; first += 2 * lanes) {
+			load(v0, first);
+			load(v1, first + lanes);
+			acc0 += v0;
+			acc1 += v1;
+		}
+		acc0 += acc1;
+		T total{};
+		for (size_t i = 0; i < lanes; ++i) total = total + acc0[i];
+		return total + sum_scalar(first, last);
+	}
+
+	template <bool Max>
+	static inline __attribute__((always_inline)) const T* extreme(const T* first, const T* last) {
+		if (static_cast<size_t>(last - first) < 2 * lanes) return extreme_scalar<Max>(first, last);
+		const T* const begin = first;
+		vec best, v;
+		load(best, first);
+		for (first += lanes; static_cast<size_t>(last - first) >= lanes; first += lanes) {
+			load(v, first);
+			best = Max ? (best < v ? v : best) : (v < best ? v : best);
+		}
+		T value = best[0];
+		for (size_t i = 1; i < lanes; ++i) value = Max ? (value < best[i] ? best[i] : value) : (best[i] < value ? best[i] : value);
+		for (; first != last; ++first) value = Max ? (value < *first ? *first : value) : (*first < value ? *first : value);
+		return find(begin, last, value);  // first position holding the extreme, as std::min_element
+	}
+
+	// Branchless binary search down to one vector's worth of elements, then
+	// count the ones below value with a single vector compare.
+	static inline __attribute__((always_inline)) const T* lower_bound(const T* first, const T* last, T value) {
+		size_t n = static_cast<size_t>(last - first);
+		while (n > lanes) {
+			const size_t half = n / 2;
+			first = first[half - 1] < value ? first + half : first;
+			n -= half;
+		}
+		vec needle, v;
+		splat(needle, value);
+		size_t below = 0;
+		size_t i = 0;
+		for (; i + lanes <= n; i += lanes) {
+			load(v, first + i);
+			const auto m = v < needle;  // lanes are 0 or -1
+			auto total = m[0];
+			for (size_t j = 1; j < lanes; ++j) total += m[j];
+			below += static_cast<size_t>(-static_cast<std::int64_t>(total));
+		}
+		for (; i < n; ++i) below += (first[i] < value);
+		return first + below;
+	}
+};
+
+#define STM_SIMD_KERNELS(ISA, ATTR, BYTES)                                                              \
+	template <typename T> ATTR const T* find_##ISA(const T* f, const T* l, T v) { return Kernels<T, BYTES>::find(f, l, v); } \
+	template <typename T> ATTR size_t count_##ISA(const T* f, const T* l, T v) { return Kernels<T, BYTES>::count(f, l, v); } \
+	template <typename T> ATTR T sum_##ISA(const T* f, const T* l) { return Kernels<T, BYTES>::sum(f, l); } \
+	template <bool Max, typename T> ATTR const T* extreme_##ISA(const T* f, const T* l) { return Kernels<T, BYTES>::template extreme<Max>(f, l); } \
+	template <typename T> ATTR const T* lower_bound_##ISA(const T* f, const T* l, T v) { return Kernels<T, BYTES>::lower_bound(f, l, v); }
+
+STM_SIMD_KERNELS(avx2, STM_TARGET_AVX2, 32)
+STM_SIMD_KERNELS(avx512, STM_TARGET_AVX512, 64)
+
+#undef STM_SIMD_KERNELS
+
+} // namespace detail
+
+#endif // STM_SIMD_X86
+
+// Kernels for a given instruction set (Scalar works everywhere; the others
+// must only be called when detected_isa() reports them)
+
+template <Isa I, typename T>
+const T* find(const T* first, const T* last, const T& value) {
+#if STM_SIMD_X86
+	if constexpr (vectorizable_v<T> && I == Isa::Avx512) return detail::find_avx512(first, last, value);
+	else if constexpr (vectorizable_v<T> && I == Isa::Avx2) return detail::find_avx2(first, last, value);
+	else
+#endif
+	return find_scalar(first, last, value);
+}
+
+template <Isa I, typename T>
+size_t count(const T* first, const T* last, const T& value) {
+#if STM_SIMD_X86
+	if constexpr (vectorizable_v<T> && I == Isa::Avx512) return detail::count_avx512(first, last, value);
+	else if constexpr (vectorizable_v<T> && I == Isa::Avx2) return detail::count_avx2(first, last, value);
+	else
+#endif
+	return count_scalar(first, last, value);
+}
+
+template <Isa I, typename T>
+T sum(const T* first, const T* last) {
+#if STM_SIMD_X86
+	if constexpr (vectorizable_v<T> && I == Isa::Avx512) return detail::sum_avx512(first, last);
+	else if constexpr (vectorizable_v<T> && I == Isa::Avx2) return detail::sum_avx2(first, last);
+	else
+#endif
+	return sum_scalar(first, last);
+}
+
+template <Isa I, bool Max, typename T>
+const T* extreme(const T* first, const T* last) {
+#if STM_SIMD_X86
+	if constexpr (vectorizable_v<T> && I == Isa::Avx512) return detail::extreme_avx512<Max>(first, last);
+	else if constexpr (vectorizable_v<T> && I == Isa::Avx2) return detail::extreme_avx2<Max>(first, last);
+	else
+#endif
+	return extreme_scalar<Max>(first, last);
+}
+
+template <Isa I, typename T>
+const T* lower_bound(const T* first, const T* last, const T& value) {
+#if STM_SIMD_X86
+	// The search ends in a single compare, where 64-byte vectors measured slower
+	if constexpr (vectorizable_v<T> && I != Isa::Scalar) return detail::lower_bound_avx2(first, last, value);
+	else
+#endif
+	return lower_bound_scalar(first, last, value);
+}
+
+// Runtime-dispatched entry points
+
+#define STM_SIMD_DISPATCH(CALL)                                  \
+	if constexpr (vectorizable_v<T>) {                           \
+		switch (detected_isa()) {                                \
+			case Isa::Avx512: return CALL(Isa::Avx512);          \
+			case Isa::Avx2: return CALL(Isa::Avx2);              \
+			case Isa::Scalar: break;                             \
+		}                                                        \
+	}                                                            \
+	return CALL(Isa::Scalar);
+
+template <typename T>
+const T* find(const T* first, const T* last, const T& value) {
+#define STM_CALL(I) find<I>(first, last, value)
+	STM_SIMD_DISPATCH(STM_CALL)
+#undef STM_CALL
+}
+
+template <typename T>
+size_t count(const T* first, const T* last, const T& value) {
+#define STM_CALL(I) count<I>(first, last, value)
+	STM_SIMD_DISPATCH(STM_CALL)
+#undef STM_CALL
+}
+
+template <typename T>
+T sum(const T* first, const T* last) {
+#define STM_CALL(I) sum<I>(first, last)
+	STM_SIMD_DISPATCH(STM_CALL)
+#undef STM_CALL
+}
+
+template <bool Max, typename T>
+const T* extreme(const T* first, const T* last) {
+#define STM_CALL(I) extreme<I, Max>(first, last)
+	STM_SIMD_DISPATCH(STM_CALL)
+#undef STM_CALL
+}
+
+template <typename T>
+const T* lower_bound(const T* first, const T* last, const T& value) {
+#define STM_CALL(I) lower_bound<I>(first, last, value)
+	STM_SIMD_DISPATCH(STM_CALL)
+#undef STM_CALL
+}
+
+#undef STM_SIMD_DISPATCH
+
+} // namespace stm::simd
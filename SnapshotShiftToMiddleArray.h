@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>    // std::max, std::min
+#include <array>        // std::array
+#include <atomic>       // std::atomic, std::atomic_ref
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t, std::uintptr_t, UINT64_MAX
+#include <new>          // ::operator new, std::align_val_t
+#include <thread>       // std::this_thread::yield
+#include <type_traits>  // std::is_trivially_copyable_v
+#include <utility>      // std::pair
+#include <vector>       // std::vector
+
+#include "ShiftToMiddleArray.h"
+
+// Shift-to-middle array with one writer thread and any number of reader threads
+// that take consistent snapshots of [head, tail) while it is being mutated.
+//
+// The writer (push/pop at both ends, operator[], clear) never waits for a
+// reader: each operation is a bounded number of steps, even while readers copy.
+// A snapshot copies the size() live elements (not the capacity) and is
+// validated seqlock-style: it is retried if the writer rewrote a slot the
+// snapshot might cover while it was being taken. Plain pushes into never-used
+// slots, and pops, do not disturb snapshots, so FIFO traffic (push_back +
+// pop_front) lets readers through on the first try; only a push into a slot
+// that was live since the last rewrite (pop_back then push_back, for instance)
+// forces a retry.
+//
+// Growing and recentering both copy the elements into a new block, which keeps
+// its own head and tail. The old block is never written again, so a reader
+// still copying out of it gets the state from just before the move. It is
+// retired rather than freed: epoch-based reclamation frees it once every
+// reader that could have seen it has finished. Up to MaxReaders snapshots run
+// at once; a further reader waits for a free slot, readers never make the
+// writer wait.
+//
+// T must be trivially copyable and lock-free as std::atomic_ref<T> (integers,
+// pointers, small PODs): slots are read by readers while the writer stores, and
+// every access goes through atomic_ref. snapshot_into() also needs T to be
+// default constructible.
+template <typename T, size_t ResizeMult = 2, size_t MaxReaders = 64>
+class SnapshotShiftToMiddleArray {
+	static_assert(std::is_trivially_copyable_v<T>, "SnapshotShiftToMiddleArray needs trivially copyable elements");
+	static_assert(std::atomic_ref<T>::is_always_lock_free, "SnapshotShiftToMiddleArray needs elements that are lock-free as std::atomic_ref<T>");
+	static_assert(ResizeMult >= 2, "ResizeMult must be at least 2");
+	static_assert(MaxReaders > 0, "MaxReaders must be positive");
+
+	static constexpr size_t cache_line = 64;
+	static constexpr std::uint64_t idle = UINT64_MAX;
+	static constexpr size_t slot_align = std::max(alignof(T), std::atomic_ref<T>::required_alignment);
+
+	// window_seq is odd while head and tail are updated
+	struct Block {
+		alignas(cache_line) std::atomic<std::uint64_t> window_seq{0};
+		std::atomic<size_t> head, tail;
+		size_t capacity;
+		T* slots;
+	};
+
+	struct Retired {
+		Block* block;
+		std::uint64_t epoch;  // readers that announced a later epoch cannot hold it
+	};
+
+	struct alignas(cache_line) ReaderSlot {
+		std::atomic<std::uint64_t> epoch{idle};
+	};
+
+	// Writer-only state
+	Block* block_;
+	size_t head_, tail_;
+	size_t dirty_lo_, dirty_hi_;  // slots possibly inside a snapshot since the last rewrite
+	std::vector<Retired> retired_;
+
+	// Published for readers. version_ is odd while slots that a snapshot may
+	// cover are rewritten.
+	alignas(cache_line) std::atomic<std::uint64_t> version_{0};
+	std::atomic<Block*> published_block_;
+
+	alignas(cache_line) std::atomic<std::uint64_t> epoch_{0};
+	mutable std::array<ReaderSlot, MaxReaders> readers_;
+
+	static Block* allocate_block(size_t capacity) {
+		T* slots = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(slot_align)));
+		Block* b = new Block;
+		b->capacity = capacity;
+		b->slots = slots;
+		return b;
+	}
+
+	static void free_block(Block* b) noexcept {
+		::operator delete(b->slots, std::align_val_t(slot_align));
+		delete b;
+	}
+
+	static T load(const T* slot) noexcept {
+		return std::atomic_ref<T>(*const_cast<T*>(slot)).load(std::memory_order_acquire);
+	}
+
+	static void store(T* slot, const T& value) noexcept {
+		std::atomic_ref<T>(*slot).store(value, std::memory_order_release);
+	}
+
+	// Writer: publish head_/tail_ in the current block
+	void publish_window() noexcept {
+		const std::uint64_t seq = block_->window_seq.load(std::memory_order_relaxed);
+		block_->window_seq.store(seq + 1, std::memory_order_relaxed);
+		block_->head.store(head_, std::memory_order_release);
+		block_->tail.store(tail_, std::memory_order_release);
+		block_->window_seq.store(seq + 2, std::memory_order_release);
+	}
+
+	// Writer: bracket changes that snapshots in progress must not accept
+	void begin_rewrite() noexcept {
+		version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	void end_rewrite() noexcept {
+		version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		dirty_lo_ = head_;
+		dirty_hi_ = tail_;
+	}
+
+	// Writer: move the elements to the middle of a new block of new_capacity
+	// and retire the old one
+	void relayout(size_t new_capacity) {
+		const size_t n = tail_ - head_;
+		const size_t new_head = (new_capacity - n) / 2;
+		Block* b = allocate_block(new_capacity);
+		for (size_t i = 0; i < n; ++i) store(b->slots + new_head + i, load(block_->slots + head_ + i));
+		b->head.store(new_head, std::memory_order_relaxed);
+		b->tail.store(new_head + n, std::memory_order_relaxed);
+		published_block_.store(b, std::memory_order_release);
+		retired_.push_back({block_, epoch_.fetch_add(1, std::memory_order_seq_cst)});
+		block_ = b;
+		head_ = dirty_lo_ = new_head;
+		tail_ = dirty_hi_ = new_head + n;
+		reclaim();
+	}
+
+	// Writer: at an edge, recenter when at most half full, else grow
+	void make_room() {
+		const size_t n = tail_ - head_;
+		if (n + 2 <= block_->capacity / 2) relayout(block_->capacity);
+		else relayout(std::max(block_->capacity * ResizeMult, n + 2));
+	}
+
+	// Reader: claim a slot and announce the current epoch in it
+	size_t enter() const noexcept {
+		static thread_local size_t hint = reinterpret_cast<std::uintptr_t>(&hint) / cache_line;
+		for (size_t tries = 0;; ++tries) {
+			const size_t i = (hint + tries) % MaxReaders;
+			std::uint64_t expected = idle;
+			std::uint64_t e = epoch_.load(std::memory_order_seq_cst);
+			if (readers_[i].epoch.compare_exchange_strong(expected, e, std::memory_order_seq_cst)) {
+				// Announce an epoch that was current after the announcement was visible
+				for (std::uint64_t now; (now = epoch_.load(std::memory_order_seq_cst)) != e; e = now) {
+					readers_[i].epoch.store(now, std::memory_order_seq_cst);
+				}
+				hint = i;
+				return i;
+			}
+			if (tries % MaxReaders == MaxReaders - 1) std::this_thread::yield();
+		}
+	}
+
+	void leave(size_t i) const noexcept { readers_[i].epoch.store(idle, std::memory_order_release); }
+
+	// Reader: a consistent (head, tail) pair of b
+	static std::pair<size_t, size_t> read_window(const Block* b) noexcept {
+		for (;;) {
+			const std::uint64_t seq = b->window_seq.load(std::memory_order_acquire);
+			const size_t h = b->head.load(std::memory_order_acquire);
+			const size_t t = b->tail.load(std::memory_order_acquire);
+			if (!(seq & 1) && b->window_seq.load(std::memory_order_acquire) == seq) return {h, t};
+		}
+	}
+
+public:
+	using value_type = T;
+
+	explicit SnapshotShiftToMiddleArray(size_t initial_capacity = 16) {
+		block_ = allocate_block(std::max<size_t>(initial_capacity, 4));
+		head_ = tail_ = dirty_lo_ = dirty_hi_ = block_->capacity / 2;
+		block_->head.store(head_, std::memory_order_relaxed);
+		block_->tail.store(tail_, std::memory_order_relaxed);
+		published_block_.store(block_, std::memory_order_relaxed);
+	}
+
+	SnapshotShiftToMiddleArray(const SnapshotShiftToMiddleArray&) = delete;
+	SnapshotShiftToMiddleArray& operator=(const SnapshotShiftToMiddleArray&) = delete;
+
+	// No reader may be active
+	~SnapshotShiftToMiddleArray() {
+		for (const Retired& r : retired_) free_block(r.block);
+		free_block(block_);
+	}
+
+	// Writer thread
+
+	void push_back(const T& value) {
+		if (tail_ == block_->capacity) [[unlikely]] make_room();
+		if (tail_ < dirty_hi_) {
+			// The slot was live since the last rewrite: a snapshot may cover it
+			begin_rewrite();
+			store(block_->slots + tail_, value);
+			++tail_;
+			publish_window();
+			end_rewrite();
+			return;
+		}
+		store(block_->slots + tail_, value);
+		dirty_hi_ = ++tail_;
+		publish_window();
+	}
+
+	void push_front(const T& value) {
+		if (head_ == 0) [[unlikely]] make_room();
+		if (head_ - 1 >= dirty_lo_) {
+			begin_rewrite();
+			store(block_->slots + head_ - 1, value);
+			--head_;
+			publish_window();
+			end_rewrite();
+			return;
+		}
+		store(block_->slots + head_ - 1, value);
+		dirty_lo_ = --head_;
+		publish_window();
+	}
+
+	void pop_back() {
+		stm::detail::check<true>(tail_ != head_, "Array is empty");
+		--tail_;
+		publish_window();
+	}
+
+	void pop_front() {
+		stm::detail::check<true>(tail_ != head_, "Array is empty");
+		++head_;
+		publish_window();
+	}
+
+	void clear() noexcept {
+		head_ = tail_ = block_->capacity / 2;
+		publish_window();
+	}
+
+	T operator[](size_t i) const noexcept { return load(block_->slots + head_ + i); }
+	T front() const noexcept { return load(block_->slots + head_); }
+	T back() const noexcept { return load(block_->slots + tail_ - 1); }
+	bool empty() const noexcept { return head_ == tail_; }
+	size_t capacity() const noexcept { return block_->capacity; }
+
+	// Frees the retired blocks no reader can still hold; growth calls it too
+	void reclaim() {
+		std::uint64_t oldest = idle;
+		for (const ReaderSlot& r : readers_) oldest = std::min(oldest, r.epoch.load(std::memory_order_seq_cst));
+		std::erase_if(retired_, [&](const Retired& r) {
+			if (r.epoch >= oldest) return false;
+			free_block(r.block);
+			return true;
+		});
+	}
+
+	// Retired blocks not freed yet
+	size_t retired_blocks() const noexcept { return retired_.size(); }
+
+	// Any thread
+
+	// The number of elements at some instant during the call
+	size_t size() const noexcept {
+		const size_t slot = enter();
+		const auto [h, t] = read_window(published_block_.load(std::memory_order_acquire));
+		leave(slot);
+		return t - h;
+	}
+
+	// Replaces out's contents with the elements as they were at one instant
+	// during the call; returns how many
+	size_t snapshot_into(std::vector<T>& out) const {
+		const size_t slot = enter();
+		for (;;) {
+			const std::uint64_t version = version_.load(std::memory_order_acquire);
+			if (version & 1) {
+				std::this_thread::yield();
+				continue;
+			}
+			const Block* b = published_block_.load(std::memory_order_acquire);
+			const auto [h, t] = read_window(b);
+			out.resize(t - h);
+			T* dst = out.data();
+			for (size_t i = h; i < t; ++i) *dst++ = load(b->slots + i);
+			if (version_.load(std::memory_order_acquire) == version) break;
+		}
+		leave(slot);
+		return out.size();
+	}
+
+	std::vector<T> snapshot() const {
+		std::vector<T> out;
+		snapshot_into(out);
+		return out;
+	}
+};
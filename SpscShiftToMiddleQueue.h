@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>    // std::min, std::max
+#include <atomic>       // std::atomic, std::memory_order
+#include <cstddef>      // std::size_t
+#include <iterator>     // std::input_iterator
+#include <memory>       // std::construct_at, std::destroy_at
+#include <new>          // ::operator new, std::align_val_t
+#include <span>         // std::span
+#include <type_traits>  // std::is_trivially_copyable_v
+#include <utility>      // std::forward, std::move
+
+// Single-producer, single-consumer queue for handing elements from one thread
+// to another without a lock.
+//
+// The elements live in a chain of contiguous blocks. The producer appends at
+// the back of the newest block and publishes how far it got with a release
+// store; the consumer reads up to that mark (acquire) and never writes to
+// anything the producer reads on the fast path. The two sides keep their
+// cursors on separate cache lines.
+//
+// Growth never moves elements and never waits for the consumer: when its block
+// is full the producer links a fresh one and carries on there. A block the
+// consumer has finished is handed back through a one-slot spare, so a queue
+// whose consumer keeps up cycles between two blocks without allocating. While
+// the consumer lags (no spare to take), each new block doubles in size up to
+// max_block elements.
+//
+// Batches: push_back_n() publishes once per block instead of once per element;
+// prepare_back()/commit_back() let the producer write straight into the
+// block (e.g. recv() into it), and front_span()/pop_front_n() give the consumer
+// the published elements of its block as one span.
+//
+// Producer-side members: push_back, emplace_back, push_back_n, prepare_back,
+// commit_back. Consumer-side members: try_pop_front, front_span, pop_front_n,
+// empty. Each side must be used by one thread at a time; construction and
+// destruction need both sides quiescent.
+template <typename T>
+class SpscShiftToMiddleQueue {
+	static constexpr size_t cache_line = 64;
+
+	struct Block {
+		std::atomic<size_t> published{0};  // elements written, in order, from slot 0
+		std::atomic<Block*> next{nullptr};
+		size_t capacity;
+
+		explicit Block(size_t n) : capacity(n) {}
+		T* slots() noexcept { return reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(this) + slots_offset); }
+	};
+
+	static constexpr size_t block_align = std::max(alignof(Block), alignof(T));
+	static constexpr size_t slots_offset = (sizeof(Block) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+	static Block* allocate_block(size_t n) {
+		void* raw = ::operator new(slots_offset + n * sizeof(T), std::align_val_t(block_align));
+		return ::new (raw) Block(n);
+	}
+
+	static void free_block(Block* b) noexcept {
+		b->~Block();
+		::operator delete(static_cast<void*>(b), std::align_val_t(block_align));
+	}
+
+	// Producer state: the block being filled and the next free slot in it
+	struct alignas(cache_line) Producer {
+		Block* block;
+		size_t tail = 0;
+	};
+
+	// Consumer state: the block being read, the next slot to read, and the last
+	// published count it saw (re-read only once that is used up)
+	struct alignas(cache_line) Consumer {
+		Block* block;
+		size_t head = 0;
+		size_t available = 0;
+	};
+
+	Producer producer_;
+	Consumer consumer_;
+	alignas(cache_line) std::atomic<Block*> spare_{nullptr};
+	size_t max_block_;
+
+	// Producer: move to a block with room for at least n elements. The current
+	// block's count is final before the link is published, so the consumer can
+	// tell an exhausted block from one still being written.
+	void next_block(size_t n) {
+		const size_t wanted = std::max(n, producer_.block->capacity);
+		Block* b = spare_.exchange(nullptr, std::memory_order_acquire);
+		if (b && b->capacity < wanted) {
+			free_block(b);
+			b = nullptr;
+		}
+		if (!b) b = allocate_block(std::max(n, std::min(producer_.block->capacity * 2, std::max(max_block_, producer_.block->capacity))));
+		producer_.block->next.store(b, std::memory_order_release);
+		producer_.block = b;
+		producer_.tail = 0;
+	}
+
+	// Consumer: refresh the published count, stepping to the next block once the
+	// current one is exhausted. Returns the number of readable elements.
+	size_t refresh() noexcept {
+		for (;;) {
+			Block* b = consumer_.block;
+			consumer_.available = b->published.load(std::memory_order_acquire);
+			if (consumer_.head < consumer_.available) return consumer_.available - consumer_.head;
+			Block* next = b->next.load(std::memory_order_acquire);
+			if (!next) return 0;
+			// Linked: the count seen after the link is final
+			consumer_.available = b->published.load(std::memory_order_acquire);
+			if (consumer_.head < consumer_.available) return consumer_.available - consumer_.head;
+			consumer_.block = next;
+			consumer_.head = consumer_.available = 0;
+			retire(b);
+		}
+	}
+
+	// Consumer: hand an exhausted block back to the producer
+	void retire(Block* b) noexcept {
+		b->published.store(0, std::memory_order_relaxed);
+		b->next.store(nullptr, std::memory_order_relaxed);
+		if (Block* old = spare_.exchange(b, std::memory_order_acq_rel)) free_block(old);
+	}
+
+public:
+	using value_type = T;
+
+	// initial_block: capacity of the first block; max_block: cap for the
+	// doubling while the consumer lags (blocks for larger batches are still made)
+	explicit SpscShiftToMiddleQueue(size_t initial_block = 1024, size_t max_block = size_t(1) << 16)
+		: max_block_(std::max<size_t>(max_block, 1)) {
+		producer_.block = consumer_.block = allocate_block(std::max<size_t>(initial_block, 1));
+	}
+
+	SpscShiftToMiddleQueue(const SpscShiftToMiddleQueue&) = delete;
+	SpscShiftToMiddleQueue& operator=(const SpscShiftToMiddleQueue&) = delete;
+
+	~SpscShiftToMiddleQueue() {
+		Block* b = consumer_.block;
+		size_t head = consumer_.head;
+		while (b) {
+			const size_t end = b->published.load(std::memory_order_acquire);
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				for (size_t i = head; i < end; ++i) std::destroy_at(b->slots() + i);
+			}
+			Block* next = b->next.load(std::memory_order_acquire);
+			free_block(b);
+			b = next;
+			head = 0;
+		}
+		if (Block* s = spare_.load(std::memory_order_acquire)) free_block(s);
+	}
+
+	// Producer side
+
+	template <typename... Args>
+	void emplace_back(Args&&... args) {
+		if (producer_.tail == producer_.block->capacity) next_block(1);
+		std::construct_at(producer_.block->slots() + producer_.tail, std::forward<Args>(args)...);
+		producer_.block->published.store(++producer_.tail, std::memory_order_release);
+	}
+
+	void push_back(const T& value) { emplace_back(value); }
+	void push_back(T&& value) { emplace_back(std::move(value)); }
+
+	// Copies n elements from first, publishing once per block filled. If a copy
+	// throws, the elements before it stay published.
+	template <std::input_iterator InputIt>
+	void push_back_n(InputIt first, size_t n) {
+		while (n > 0) {
+			if (producer_.tail == producer_.block->capacity) next_block(1);
+			T* slots = producer_.block->slots();
+			const size_t end = producer_.tail + std::min(n, producer_.block->capacity - producer_.tail);
+			size_t i = producer_.tail;
+			try {
+				for (; i < end; ++i, ++first) std::construct_at(slots + i, *first);
+			} catch (...) {
+				producer_.tail = i;
+				producer_.block->published.store(i, std::memory_order_release);
+				throw;
+			}
+			n -= end - producer_.tail;
+			producer_.tail = end;
+			producer_.block->published.store(end, std::memory_order_release);
+		}
+	}
+
+	// Zero-copy writes for trivially copyable T: at least n writable slots at the
+	// back, not visible to the consumer until commit_back(k) publishes the first
+	// k of them. The span stays valid until the next producer call.
+	std::span<T> prepare_back(size_t n) requires std::is_trivially_copyable_v<T> {
+		if (producer_.block->capacity - producer_.tail < n) next_block(n);
+		return {producer_.block->slots() + producer_.tail, producer_.block->capacity - producer_.tail};
+	}
+
+	void commit_back(size_t k) noexcept requires std::is_trivially_copyable_v<T> {
+		producer_.tail += k;
+		producer_.block->published.store(producer_.tail, std::memory_order_release);
+	}
+
+	// Consumer side
+
+	bool empty() noexcept { return consumer_.head == consumer_.available && refresh() == 0; }
+
+	bool try_pop_front(T& out) {
+		if (consumer_.head == consumer_.available && refresh() == 0) return false;
+		T* slot = consumer_.block->slots() + consumer_.head;
+		out = std::move(*slot);
+		std::destroy_at(slot);
+		++consumer_.head;
+		return true;
+	}
+
+	// The published elements of the consumer's current block, oldest first. Empty
+	// only when nothing is published; the elements after a block boundary appear
+	// once the span has been consumed.
+	std::span<T> front_span() noexcept {
+		if (consumer_.head == consumer_.available) refresh();
+		return {consumer_.block->slots() + consumer_.head, consumer_.available - consumer_.head};
+	}
+
+	// Removes the first n elements of front_span() (n <= its size)
+	void pop_front_n(size_t n) noexcept {
+		T* slots = consumer_.block->slots();
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			for (size_t i = consumer_.head; i < consumer_.head + n; ++i) std::destroy_at(slots + i);
+		}
+		consumer_.head += n;
+	}
+};
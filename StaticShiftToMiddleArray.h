@@ -0,0 +1,395 @@
+#pragma once
+
+#include <cassert>      // assert()
+#include <compare>      // operator<=>
+#include <cstddef>      // std::size_t, std::ptrdiff_t
+#include <initializer_list> // std::initializer_list
+#include <iterator>     // std::random_access_iterator_tag, std::reverse_iterator
+#include <memory>       // std::construct_at, std::destroy_at
+#include <stdexcept>    // std::length_error, std::out_of_range
+#include <type_traits>  // std::is_trivially_destructible_v, std::conditional_t
+#include <utility>      // std::move, std::forward
+
+namespace stm {
+
+// What a StaticShiftToMiddleArray does with an element that does not fit:
+// - Fail: throw std::length_error (in a constant expression: a compile error)
+// - Overwrite: evict the element at the far end (push_back evicts the front,
+//   push_front the back), as a ring buffer does. The array then is a ring
+//   buffer: the window wraps around the slots instead of recentering, so an
+//   overwriting push moves nothing.
+// - Drop: discard the new element; the push or insert returns false
+enum class OverflowPolicy { Fail, Overwrite, Drop };
+
+} // namespace stm
+
+// Fixed-capacity shift-to-middle array: the elements live inside the object,
+// nothing is ever allocated, and an edge hit recenters the window in the block
+// instead of growing it (with OverflowPolicy::Overwrite it wraps around the
+// block instead). Only when all N slots are in use does the overflow policy
+// apply.
+//
+// Everything is constexpr, so tables can be built at compile time:
+//
+//   constexpr auto table = [] {
+//       StaticShiftToMiddleArray<int, 16> a;
+//       for (int i = 0; i < 8; ++i) a.push_front(i * i);
+//       return a;
+//   }();
+//
+// Elements are stored in an array of single-member unions so that they can be
+// constructed and destroyed individually during constant evaluation. For the
+// same reason there is no data() pointer; iterators step through the slots.
+template <typename T, size_t N, stm::OverflowPolicy Overflow = stm::OverflowPolicy::Fail>
+class StaticShiftToMiddleArray {
+    static_assert(N > 0, "StaticShiftToMiddleArray needs at least one slot");
+
+    union Slot {
+        T value;
+        constexpr Slot() noexcept {}
+        constexpr ~Slot() requires std::is_trivially_destructible_v<T> = default;
+        constexpr ~Slot() {}
+    };
+
+    static constexpr bool ring = Overflow == stm::OverflowPolicy::Overwrite;
+
+    // The window is the positions [head, tail). Without wrapping they are slot
+    // indices. In ring mode head stays below N, tail at most N past it, and
+    // position p is slot p mod N.
+    Slot slots_[N];
+    size_t head = N / 2, tail = N / 2;
+
+    static constexpr size_t slot_of(size_t pos) noexcept {
+        if constexpr (ring) return pos >= N ? pos - N : pos;
+        else return pos;
+    }
+
+    constexpr T* at_slot(size_t pos) noexcept { return &slots_[slot_of(pos)].value; }
+    constexpr const T* at_slot(size_t pos) const noexcept { return &slots_[slot_of(pos)].value; }
+
+    // Moves the element at position from to the empty position to
+    constexpr void move_slot(size_t from, size_t to) {
+        std::construct_at(at_slot(to), std::move(*at_slot(from)));
+        std::destroy_at(at_slot(from));
+    }
+
+    // Ring mode: renumbers the positions so that head - 1 is valid
+    constexpr void rebase_front() noexcept {
+        if constexpr (ring) {
+            if (head == 0) {
+                head += N;
+                tail += N;
+            }
+        }
+    }
+
+    // Ring mode: brings head back below N after it moved forward
+    constexpr void normalize() noexcept {
+        if constexpr (ring) {
+            if (head >= N) {
+                head -= N;
+                tail -= N;
+            }
+        }
+    }
+
+    // Moves the window so that `target` becomes its first slot
+    constexpr void move_window(size_t target) {
+        if (target < head) {
+            for (size_t i = head; i < tail; ++i) move_slot(i, i - (head - target));
+        } else {
+            for (size_t i = tail; i-- > head;) move_slot(i, i + (target - head));
+        }
+        tail = target + (tail - head);
+        head = target;
+    }
+
+    // Called when a push hits an edge while slots are free on the other side:
+    // center the window, rounding towards the side that needs the room.
+    constexpr void recenter(bool for_front) {
+        const size_t spare = N - size();
+        move_window(for_front ? spare - spare / 2 : spare / 2);
+    }
+
+    // Applies the overflow policy when all slots are taken. Returns false if the
+    // new element has to be discarded; otherwise one slot has been freed at the
+    // front (evict_front) or at the back.
+    constexpr bool make_space(bool evict_front) {
+        if constexpr (Overflow == stm::OverflowPolicy::Fail) {
+            throw std::length_error("StaticShiftToMiddleArray is full");
+        } else if constexpr (Overflow == stm::OverflowPolicy::Drop) {
+            return false;
+        } else {
+            if (evict_front) pop_front();
+            else pop_back();
+            return true;
+        }
+    }
+
+    template <typename U>
+    constexpr bool emplace_back_impl(U&& value) {
+        if constexpr (ring) {
+            if (full()) [[unlikely]] {
+                T incoming(std::forward<U>(value));  // value may be the evicted front
+                pop_front();
+                std::construct_at(at_slot(tail), std::move(incoming));
+            } else {
+                std::construct_at(at_slot(tail), std::forward<U>(value));
+            }
+        } else if (tail == N) [[unlikely]] {
+            T incoming(std::forward<U>(value));  // value may be one of ours, about to move
+            if (full() && !make_space(true)) return false;
+            if (tail == N) recenter(false);
+            std::construct_at(at_slot(tail), std::move(incoming));
+        } else {
+            std::construct_at(at_slot(tail), std::forward<U>(value));
+        }
+        ++tail;
+        return true;
+    }
+
+    template <typename U>
+    constexpr bool emplace_front_impl(U&& value) {
+        if constexpr (ring) {
+            if (full()) [[unlikely]] {
+                T incoming(std::forward<U>(value));
+                pop_back();
+                rebase_front();
+                std::construct_at(at_slot(head - 1), std::move(incoming));
+            } else {
+                rebase_front();
+                std::construct_at(at_slot(head - 1), std::forward<U>(value));
+            }
+        } else if (head == 0) [[unlikely]] {
+            T incoming(std::forward<U>(value));
+            if (full() && !make_space(false)) return false;
+            if (head == 0) recenter(true);
+            std::construct_at(at_slot(head - 1), std::move(incoming));
+        } else {
+            std::construct_at(at_slot(head - 1), std::forward<U>(value));
+        }
+        --head;
+        return true;
+    }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    static constexpr stm::OverflowPolicy overflow_policy = Overflow;
+
+    constexpr StaticShiftToMiddleArray() noexcept = default;
+
+    constexpr StaticShiftToMiddleArray(std::initializer_list<T> values) {
+        for (const T& v : values) push_back(v);
+    }
+
+    constexpr StaticShiftToMiddleArray(const StaticShiftToMiddleArray& other) : head(other.head), tail(other.head) {
+        for (; tail < other.tail; ++tail) std::construct_at(at_slot(tail), *other.at_slot(tail));
+    }
+
+    constexpr StaticShiftToMiddleArray(StaticShiftToMiddleArray&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : head(other.head), tail(other.head)
+    {
+        for (; tail < other.tail; ++tail) std::construct_at(at_slot(tail), std::move(*other.at_slot(tail)));
+        other.clear();
+    }
+
+    constexpr StaticShiftToMiddleArray& operator=(const StaticShiftToMiddleArray& other) {
+        if (this != &other) {
+            clear();
+            head = tail = other.head;
+            for (; tail < other.tail; ++tail) std::construct_at(at_slot(tail), *other.at_slot(tail));
+        }
+        return *this;
+    }
+
+    constexpr StaticShiftToMiddleArray& operator=(StaticShiftToMiddleArray&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            clear();
+            head = tail = other.head;
+            for (; tail < other.tail; ++tail) std::construct_at(at_slot(tail), std::move(*other.at_slot(tail)));
+            other.clear();
+        }
+        return *this;
+    }
+
+    constexpr ~StaticShiftToMiddleArray() requires std::is_trivially_destructible_v<T> = default;
+    constexpr ~StaticShiftToMiddleArray() { clear(); }
+
+    constexpr void swap(StaticShiftToMiddleArray& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        StaticShiftToMiddleArray tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend constexpr void swap(StaticShiftToMiddleArray& a, StaticShiftToMiddleArray& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+    // Capacity observers
+
+    constexpr size_t size() const noexcept { return tail - head; }
+    constexpr bool empty() const noexcept { return head == tail; }
+    constexpr bool full() const noexcept { return size() == N; }
+    static constexpr size_t capacity() noexcept { return N; }
+    // Free slots in front of / behind the window; in ring mode every free slot
+    // is on both sides
+    constexpr size_t front_capacity() const noexcept { return ring ? N - size() : head; }
+    constexpr size_t back_capacity() const noexcept { return ring ? N - size() : N - tail; }
+
+    // Accessors
+
+    constexpr T& operator[](size_t index) {
+        check(index < size(), "Index out of range");
+        return *at_slot(head + index);
+    }
+
+    constexpr const T& operator[](size_t index) const {
+        check(index < size(), "Index out of range");
+        return *at_slot(head + index);
+    }
+
+    constexpr T& front() { check(!empty(), "Array is empty"); return *at_slot(head); }
+    constexpr const T& front() const { check(!empty(), "Array is empty"); return *at_slot(head); }
+    constexpr T& back() { check(!empty(), "Array is empty"); return *at_slot(tail - 1); }
+    constexpr const T& back() const { check(!empty(), "Array is empty"); return *at_slot(tail - 1); }
+
+    // Modifiers. Pushes and inserts return whether the value was stored; only
+    // OverflowPolicy::Drop ever returns false.
+
+    constexpr bool push_back(const T& value) { return emplace_back_impl(value); }
+    constexpr bool push_back(T&& value) { return emplace_back_impl(std::move(value)); }
+    constexpr bool push_front(const T& value) { return emplace_front_impl(value); }
+    constexpr bool push_front(T&& value) { return emplace_front_impl(std::move(value)); }
+    constexpr bool push(const T& value) { return push_back(value); }
+    constexpr bool push(T&& value) { return push_back(std::move(value)); }
+
+    constexpr void pop_front() {
+        if (empty()) return;
+        std::destroy_at(at_slot(head));
+        ++head;
+        normalize();
+    }
+
+    constexpr void pop_back() {
+        if (empty()) return;
+        --tail;
+        std::destroy_at(at_slot(tail));
+    }
+
+    constexpr void pop() { pop_front(); }
+
+    // Inserts before position at, shifting the shorter side (or the only side
+    // with a free slot). When full, Overwrite evicts the element at the end
+    // farther from at.
+    constexpr bool insert(size_t at, const T& value) {
+        if (at > size()) {
+            throw std::out_of_range("Insert position out of range");
+        }
+        T incoming(value);  // value may be one of ours, about to move
+        if (full()) {
+            const bool evict_front = at > size() - at;
+            if (!make_space(evict_front)) return false;
+            if (evict_front) --at;
+        }
+        const bool shorter_front = at < size() - at;
+        if (ring ? shorter_front : ((shorter_front && head > 0) || tail == N)) {
+            rebase_front();
+            for (size_t i = head; i < head + at; ++i) move_slot(i, i - 1);
+            --head;
+        } else {
+            for (size_t i = tail; i-- > head + at;) move_slot(i, i + 1);
+            ++tail;
+        }
+        std::construct_at(at_slot(head + at), std::move(incoming));
+        return true;
+    }
+
+    constexpr void delete_at(size_t index) {
+        check(index < size(), "StaticShiftToMiddleArray::delete_at index out of range");
+        std::destroy_at(at_slot(head + index));
+        if (index < size() / 2) {
+            for (size_t i = head + index; i-- > head;) move_slot(i, i + 1);
+            ++head;
+            normalize();
+        } else {
+            for (size_t i = head + index + 1; i < tail; ++i) move_slot(i, i - 1);
+            --tail;
+        }
+    }
+
+    constexpr void clear() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = head; i < tail; ++i) std::destroy_at(at_slot(i));
+        }
+        head = tail = N / 2;
+    }
+
+    constexpr bool operator==(const StaticShiftToMiddleArray& other) const {
+        if (size() != other.size()) return false;
+        for (size_t i = 0; i < size(); ++i) {
+            if (!((*this)[i] == other[i])) return false;
+        }
+        return true;
+    }
+
+    // Iterators hold a window position and index the slots with it, which keeps
+    // them valid in constant expressions
+
+    template <bool Const>
+    class IteratorBase {
+        using slot_t = std::conditional_t<Const, const Slot, Slot>;
+        slot_t* slots = nullptr;
+        size_t pos = 0;  // a window position, see slot_of()
+        template <bool> friend class IteratorBase;
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        constexpr IteratorBase() = default;
+        constexpr IteratorBase(slot_t* s, size_t p) : slots(s), pos(p) {}
+        template <bool C = Const> requires C
+        constexpr IteratorBase(const IteratorBase<false>& other) : slots(other.slots), pos(other.pos) {}
+
+        constexpr reference operator*() const { return slots[slot_of(pos)].value; }
+        constexpr pointer operator->() const { return &slots[slot_of(pos)].value; }
+        constexpr reference operator[](difference_type n) const { return *(*this + n); }
+        constexpr IteratorBase& operator++() { ++pos; return *this; }
+        constexpr IteratorBase operator++(int) { auto tmp = *this; ++pos; return tmp; }
+        constexpr IteratorBase& operator--() { --pos; return *this; }
+        constexpr IteratorBase operator--(int) { auto tmp = *this; --pos; return tmp; }
+        constexpr IteratorBase& operator+=(difference_type n) { pos += static_cast<size_t>(n); return *this; }
+        constexpr IteratorBase& operator-=(difference_type n) { pos -= static_cast<size_t>(n); return *this; }
+        constexpr IteratorBase operator+(difference_type n) const { return IteratorBase(slots, pos + static_cast<size_t>(n)); }
+        constexpr IteratorBase operator-(difference_type n) const { return IteratorBase(slots, pos - static_cast<size_t>(n)); }
+        friend constexpr IteratorBase operator+(difference_type n, const IteratorBase& it) { return it + n; }
+        constexpr difference_type operator-(const IteratorBase& other) const { return static_cast<difference_type>(pos - other.pos); }
+        constexpr bool operator==(const IteratorBase& other) const { return pos == other.pos; }
+        constexpr auto operator<=>(const IteratorBase& other) const { return pos <=> other.pos; }
+    };
+
+    using iterator = IteratorBase<false>;
+    using const_iterator = IteratorBase<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    constexpr iterator begin() { return iterator(slots_, head); }
+    constexpr iterator end() { return iterator(slots_, tail); }
+    constexpr const_iterator begin() const { return const_iterator(slots_, head); }
+    constexpr const_iterator end() const { return const_iterator(slots_, tail); }
+    constexpr const_iterator cbegin() const { return begin(); }
+    constexpr const_iterator cend() const { return end(); }
+    constexpr reverse_iterator rbegin() { return reverse_iterator(end()); }
+    constexpr reverse_iterator rend() { return reverse_iterator(begin()); }
+    constexpr const_reverse_iterator crbegin() const { return const_reverse_iterator(cend()); }
+    constexpr const_reverse_iterator crend() const { return const_reverse_iterator(cbegin()); }
+
+private:
+    static constexpr void check([[maybe_unused]] bool ok, [[maybe_unused]] const char* msg) {
+        assert(ok && msg);
+    }
+};
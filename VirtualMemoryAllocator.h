@@ -0,0 +1,130 @@
+#pragma once
+
+#if !defined(__linux__)
+#error "VirtualMemoryAllocator.h requires Linux (mmap/mprotect/madvise)"
+#endif
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uintptr_t
+#include <new>          // std::bad_alloc
+#include <type_traits>  // std::true_type
+
+#include <sys/mman.h>   // mmap, munmap, mprotect, madvise
+#include <unistd.h>     // sysconf
+
+// Allocator that backs every block with its own ReserveBytes of address space.
+//
+// allocate() reserves the range with PROT_NONE (no memory is committed), places
+// the block in its center and commits only the pages the block covers. Besides
+// the standard interface it offers two in-place hooks that ShiftToMiddleArray
+// picks up automatically:
+//
+//   extend(p, n, front, back) grows [p, p + n) by `front` elements below and
+//                             `back` elements above by committing pages; the
+//                             elements stay where they are. Returns the new
+//                             start (p - front) or nullptr if the reservation
+//                             is exhausted.
+//   trim(p, n, front, back)   gives `front`/`back` elements at either end back
+//                             to the kernel (MADV_DONTNEED + PROT_NONE) and
+//                             returns the new start (p + front).
+//
+// Reservations are aligned to ReserveBytes, so deallocate() finds the mapping
+// from any pointer into it. ReserveBytes must be a power of two; the default
+// (64 GiB) is address space only and costs no memory.
+template <typename T, std::size_t ReserveBytes = (std::size_t(1) << 36)>
+class VirtualMemoryAllocator {
+    static_assert((ReserveBytes & (ReserveBytes - 1)) == 0, "ReserveBytes must be a power of two");
+    static_assert(ReserveBytes >= (std::size_t(1) << 16), "ReserveBytes is too small");
+
+    static std::size_t page_size() noexcept {
+        static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    static std::uintptr_t page_down(std::uintptr_t x) noexcept { return x & ~(page_size() - 1); }
+    static std::uintptr_t page_up(std::uintptr_t x) noexcept { return page_down(x + page_size() - 1); }
+
+    static std::uintptr_t base_of(const T* p) noexcept {
+        return reinterpret_cast<std::uintptr_t>(p) & ~(static_cast<std::uintptr_t>(ReserveBytes) - 1);
+    }
+
+    static bool commit(std::uintptr_t first, std::uintptr_t last) noexcept {
+        return first >= last || mprotect(reinterpret_cast<void*>(first), last - first, PROT_READ | PROT_WRITE) == 0;
+    }
+
+    static void decommit(std::uintptr_t first, std::uintptr_t last) noexcept {
+        if (first >= last) return;
+        madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+        mprotect(reinterpret_cast<void*>(first), last - first, PROT_NONE);
+    }
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind { using other = VirtualMemoryAllocator<U, ReserveBytes>; };
+
+    static constexpr std::size_t reserve_bytes = ReserveBytes;
+
+    VirtualMemoryAllocator() noexcept = default;
+
+    template <typename U>
+    VirtualMemoryAllocator(const VirtualMemoryAllocator<U, ReserveBytes>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        const std::size_t bytes = n * sizeof(T);
+        if (n > ReserveBytes / sizeof(T)) throw std::bad_alloc();
+
+        // Over-reserve twice the size, then cut it down to an aligned reservation
+        void* raw = mmap(nullptr, 2 * ReserveBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (raw == MAP_FAILED) throw std::bad_alloc();
+        const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+        const std::uintptr_t base = (start + ReserveBytes - 1) & ~(static_cast<std::uintptr_t>(ReserveBytes) - 1);
+        if (base > start) munmap(raw, base - start);
+        if (start + 2 * ReserveBytes > base + ReserveBytes) {
+            munmap(reinterpret_cast<void*>(base + ReserveBytes), start + 2 * ReserveBytes - (base + ReserveBytes));
+        }
+
+        const std::uintptr_t first = page_down(base + (ReserveBytes - bytes) / 2);
+        if (!commit(first, page_up(first + bytes))) {
+            munmap(reinterpret_cast<void*>(base), ReserveBytes);
+            throw std::bad_alloc();
+        }
+        return reinterpret_cast<T*>(first);
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        munmap(reinterpret_cast<void*>(base_of(p)), ReserveBytes);
+    }
+
+    T* extend(T* p, std::size_t n, std::size_t front, std::size_t back) noexcept {
+        const std::uintptr_t base = base_of(p);
+        const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(p);
+        const std::uintptr_t last = first + n * sizeof(T);
+        if (front * sizeof(T) > first - base || back * sizeof(T) > base + ReserveBytes - last) return nullptr;
+
+        const std::uintptr_t new_first = first - front * sizeof(T);
+        const std::uintptr_t new_last = last + back * sizeof(T);
+        if (!commit(page_down(new_first), page_down(first)) || !commit(page_up(last), page_up(new_last))) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(new_first);
+    }
+
+    T* trim(T* p, std::size_t n, std::size_t front, std::size_t back) noexcept {
+        const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(p);
+        const std::uintptr_t last = first + n * sizeof(T);
+        const std::uintptr_t new_first = first + front * sizeof(T);
+        const std::uintptr_t new_last = last - back * sizeof(T);
+        // Only whole pages outside the remaining block are released
+        decommit(page_down(first), page_down(new_first));
+        decommit(page_up(new_last), page_up(last));
+        return reinterpret_cast<T*>(new_first);
+    }
+};
+
+template <typename T, typename U, std::size_t ReserveBytes>
+bool operator==(const VirtualMemoryAllocator<T, ReserveBytes>&, const VirtualMemoryAllocator<U, ReserveBytes>&) noexcept {
+    return true;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>    // std::max
+#include <atomic>       // std::atomic, std::memory_order
+#include <bit>          // std::bit_ceil
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::int64_t
+#include <memory>       // std::unique_ptr
+#include <type_traits>  // std::is_trivially_copyable_v
+#include <vector>       // std::vector
+
+// Chase-Lev work-stealing deque: one owner thread pushes and pops at the back,
+// any number of thieves steal from the front.
+//
+// The owner's push_back/pop_back are lock-free and, outside of growth and the
+// race for the last element, touch no shared cache line other than the
+// deque's own indices. A thief claims the front element with one CAS on head;
+// a thief that loses the race (to another thief, or to the owner taking the
+// last element) gets nothing and should look elsewhere.
+//
+// Layout: the elements occupy [head, tail) of an unbounded index space mapped
+// onto a power-of-two block, wrapping around like ShiftToMiddleArray's ring
+// mode (Policy::ring_wrap). Recentering in place is not an option here: a
+// thief may still be reading the front of the block while the owner works on
+// it. When the block is full, the owner copies the elements into a block twice
+// as large and publishes it. Thieves holding the old block still read valid
+// elements from it, so old blocks are kept until the deque is destroyed
+// (together at most the size of the current block).
+//
+// T must be trivially copyable (typically a task pointer): slots are read by
+// thieves racing with the owner and are accessed as relaxed atomics.
+template <typename T>
+class WorkStealingDeque {
+	static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque holds trivially copyable elements (e.g. task pointers)");
+
+	struct Block {
+		size_t mask;
+		std::unique_ptr<std::atomic<T>[]> slots;
+
+		explicit Block(size_t capacity) : mask(capacity - 1), slots(new std::atomic<T>[capacity]) {}
+		size_t capacity() const noexcept { return mask + 1; }
+		T get(std::int64_t i) const noexcept { return slots[static_cast<size_t>(i) & mask].load(std::memory_order_relaxed); }
+		void put(std::int64_t i, T value) noexcept { slots[static_cast<size_t>(i) & mask].store(value, std::memory_order_relaxed); }
+	};
+
+	static constexpr size_t cache_line = 64;
+
+	alignas(cache_line) std::atomic<std::int64_t> head_{0};  // thieves' end
+	alignas(cache_line) std::atomic<std::int64_t> tail_{0};  // owner's end
+	std::atomic<Block*> block_;
+	std::vector<std::unique_ptr<Block>> blocks_;             // owner only; the last is current
+
+	// Owner: move [head, tail) into a block twice as large
+	Block* grow(Block* old, std::int64_t head, std::int64_t tail) {
+		blocks_.push_back(std::make_unique<Block>(old->capacity() * 2));
+		Block* b = blocks_.back().get();
+		for (std::int64_t i = head; i < tail; ++i) b->put(i, old->get(i));
+		block_.store(b, std::memory_order_release);
+		return b;
+	}
+
+public:
+	using value_type = T;
+
+	explicit WorkStealingDeque(size_t initial_capacity = 256) {
+		blocks_.push_back(std::make_unique<Block>(std::bit_ceil(std::max<size_t>(initial_capacity, 2))));
+		block_.store(blocks_.back().get(), std::memory_order_relaxed);
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	// Owner
+
+	void push_back(T value) {
+		const std::int64_t tail = tail_.load(std::memory_order_relaxed);
+		const std::int64_t head = head_.load(std::memory_order_acquire);
+		Block* b = block_.load(std::memory_order_relaxed);
+		if (tail - head >= static_cast<std::int64_t>(b->capacity())) b = grow(b, head, tail);
+		b->put(tail, value);
+		tail_.store(tail + 1, std::memory_order_release);
+	}
+
+	// Takes the newest element; false if the deque is empty or a thief took the
+	// last one first
+	bool pop_back(T& out) {
+		const std::int64_t tail = tail_.load(std::memory_order_relaxed) - 1;
+		Block* b = block_.load(std::memory_order_relaxed);
+		tail_.store(tail, std::memory_order_seq_cst);  // reserve it before looking at head
+		std::int64_t head = head_.load(std::memory_order_seq_cst);
+		if (head > tail) {
+			tail_.store(tail + 1, std::memory_order_relaxed);
+			return false;
+		}
+		out = b->get(tail);
+		if (head < tail) return true;
+		// Last element: thieves may be after it too
+		const bool won = head_.compare_exchange_strong(head, head + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		tail_.store(tail + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	// Thieves (any thread)
+
+	// Takes the oldest element; false if the deque looked empty or another
+	// thread claimed it first
+	bool steal_front(T& out) {
+		std::int64_t head = head_.load(std::memory_order_seq_cst);
+		const std::int64_t tail = tail_.load(std::memory_order_seq_cst);
+		if (head >= tail) return false;
+		const T value = block_.load(std::memory_order_acquire)->get(head);
+		if (!head_.compare_exchange_strong(head, head + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+		out = value;
+		return true;
+	}
+
+	// Snapshots; exact only while no other thread uses the deque
+
+	size_t size() const noexcept {
+		const std::int64_t n = tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+		return n > 0 ? static_cast<size_t>(n) : 0;
+	}
+
+	bool empty() const noexcept { return size() == 0; }
+
+	size_t capacity() const noexcept { return block_.load(std::memory_order_acquire)->capacity(); }
+};
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>    // std::max
+#include <atomic>       // std::atomic
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint32_t, std::uint64_t, std::uintptr_t
+#include <exception>    // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <functional>   // std::function
+#include <memory>       // std::unique_ptr
+#include <mutex>        // std::mutex, std::lock_guard
+#include <thread>       // std::thread, std::this_thread::yield
+#include <utility>      // std::exchange, std::forward, std::move
+#include <vector>       // std::vector
+
+#include "ShiftToMiddleArray.h"
+#include "WorkStealingDeque.h"
+
+// Fork/join thread pool over WorkStealingDeques, one per worker.
+//
+// A task spawned on a worker goes to the back of that worker's deque, and the
+// worker takes its own work back from there (newest first, while it is still in
+// cache). An idle worker steals the oldest task of another worker, which in a
+// divide-and-conquer computation is the largest piece left. Tasks spawned from
+// outside the pool go through a shared injection queue (a ShiftToMiddleArray
+// under a mutex).
+//
+//   WorkStealingPool pool;
+//   WorkStealingPool::TaskGroup group(pool);
+//   group.run([&] { left = fib(pool, n - 1); });
+//   right = fib(pool, n - 2);
+//   group.wait();  // runs other tasks until the group's are done
+//
+// TaskGroup::wait() never blocks a worker: it keeps executing tasks (its own
+// first) until the group is complete, so nested groups cannot deadlock the
+// pool. An exception thrown by a task is rethrown by wait() (the first one, if
+// several threw); the group's other tasks still run.
+//
+// Workers with nothing to run or steal go to sleep on a futex (std::atomic::wait)
+// and are woken by the next spawn.
+class WorkStealingPool {
+public:
+	class TaskGroup;
+
+private:
+	struct Task {
+		std::function<void()> fn;
+		TaskGroup* group;
+	};
+
+	struct alignas(64) Worker {
+		WorkStealingDeque<Task*> deque;
+		std::uint64_t rng;  // victim selection
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers_;
+	std::vector<std::thread> threads_;
+
+	std::mutex inject_mutex_;
+	ShiftToMiddleArray<Task*> injected_;
+	std::atomic<size_t> injected_count_{0};
+
+	std::atomic<std::uint32_t> wake_seq_{0};
+	std::atomic<int> sleeping_{0};
+	std::atomic<bool> stop_{false};
+
+	static inline thread_local WorkStealingPool* current_pool_ = nullptr;
+	static inline thread_local size_t current_index_ = 0;
+
+	Worker* current_worker() const noexcept {
+		return current_pool_ == this ? workers_[current_index_].get() : nullptr;
+	}
+
+	void notify() noexcept {
+		// A read-modify-write reads the latest count. Either it comes after a
+		// sleeper's increment in sleep() and sees it, or it comes before and the
+		// sleeper's last scan (after its own increment) sees the new task.
+		if (sleeping_.fetch_add(0, std::memory_order_acq_rel) > 0) {
+			wake_seq_.fetch_add(1, std::memory_order_release);
+			wake_seq_.notify_one();
+		}
+	}
+
+	void submit(Task* task) {
+		if (Worker* w = current_worker()) {
+			w->deque.push_back(task);
+		} else {
+			std::lock_guard<std::mutex> lock(inject_mutex_);
+			injected_.push_back(task);
+			injected_count_.fetch_add(1, std::memory_order_relaxed);
+		}
+		notify();
+	}
+
+	Task* take_injected() {
+		if (injected_count_.load(std::memory_order_relaxed) == 0) return nullptr;
+		std::lock_guard<std::mutex> lock(inject_mutex_);
+		if (injected_.empty()) return nullptr;
+		Task* task = injected_.front();
+		injected_.pop_front();
+		injected_count_.fetch_sub(1, std::memory_order_relaxed);
+		return task;
+	}
+
+	// One pass over every other worker, starting at a random one
+	Task* steal(Worker* self) {
+		const size_t n = workers_.size();
+		std::uint64_t r = self ? self->rng : reinterpret_cast<std::uintptr_t>(&r);
+		r ^= r << 13;
+		r ^= r >> 7;
+		r ^= r << 17;
+		if (self) self->rng = r;
+		const size_t start = static_cast<size_t>(r % n);
+		Task* task = nullptr;
+		for (size_t i = 0; i < n; ++i) {
+			Worker* victim = workers_[(start + i) % n].get();
+			if (victim != self && victim->deque.steal_front(task)) return task;
+		}
+		return nullptr;
+	}
+
+	// Own deque, then injected tasks, then other workers
+	Task* find_task(Worker* self) {
+		Task* task = nullptr;
+		if (self && self->deque.pop_back(task)) return task;
+		if ((task = take_injected())) return task;
+		return steal(self);
+	}
+
+	static void execute(Task* task);
+
+	void sleep(Worker* self) {
+		const std::uint32_t seen = wake_seq_.load(std::memory_order_acquire);
+		sleeping_.fetch_add(1, std::memory_order_acq_rel);
+		if (!stop_.load(std::memory_order_relaxed)) {
+			if (Task* task = find_task(self)) {
+				sleeping_.fetch_sub(1, std::memory_order_relaxed);
+				execute(task);
+				return;
+			}
+			wake_seq_.wait(seen, std::memory_order_acquire);
+		}
+		sleeping_.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void worker_loop(size_t index) {
+		current_pool_ = this;
+		current_index_ = index;
+		Worker* self = workers_[index].get();
+		int idle = 0;
+		while (!stop_.load(std::memory_order_acquire)) {
+			if (Task* task = find_task(self)) {
+				execute(task);
+				idle = 0;
+			} else if (++idle < 64) {
+				std::this_thread::yield();
+			} else {
+				sleep(self);
+				idle = 0;
+			}
+		}
+		current_pool_ = nullptr;
+	}
+
+public:
+	// Runs a group of tasks on the pool and waits for all of them
+	class TaskGroup {
+		friend class WorkStealingPool;
+
+		WorkStealingPool& pool_;
+		std::atomic<size_t> pending_{0};
+		std::mutex error_mutex_;
+		std::exception_ptr error_;
+
+		void finish(std::exception_ptr error) noexcept {
+			if (error) {
+				std::lock_guard<std::mutex> lock(error_mutex_);
+				if (!error_) error_ = std::move(error);
+			}
+			pending_.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		// Runs tasks until every task of the group has finished
+		void help() noexcept {
+			Worker* self = pool_.current_worker();
+			while (pending_.load(std::memory_order_acquire) != 0) {
+				if (Task* task = pool_.find_task(self)) execute(task);
+				else std::this_thread::yield();
+			}
+		}
+
+	public:
+		explicit TaskGroup(WorkStealingPool& pool) : pool_(pool) {}
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		// Waits for stragglers, dropping their exceptions
+		~TaskGroup() { help(); }
+
+		template <typename F>
+		void run(F&& f) {
+			pending_.fetch_add(1, std::memory_order_relaxed);
+			try {
+				std::unique_ptr<Task> task(new Task{std::function<void()>(std::forward<F>(f)), this});
+				pool_.submit(task.get());
+				task.release();
+			} catch (...) {
+				// Never published, so nothing will finish it
+				pending_.fetch_sub(1, std::memory_order_relaxed);
+				throw;
+			}
+		}
+
+		void wait() {
+			help();
+			std::lock_guard<std::mutex> lock(error_mutex_);
+			if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+		}
+	};
+
+	// threads: number of workers; 0 uses hardware_concurrency()
+	explicit WorkStealingPool(size_t threads = 0) {
+		if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+		for (size_t i = 0; i < threads; ++i) {
+			workers_.push_back(std::make_unique<Worker>());
+			workers_.back()->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+		}
+		for (size_t i = 0; i < threads; ++i) threads_.emplace_back([this, i] { worker_loop(i); });
+	}
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	// Every TaskGroup must have been waited for
+	~WorkStealingPool() {
+		stop_.store(true, std::memory_order_release);
+		wake_seq_.fetch_add(1, std::memory_order_release);
+		wake_seq_.notify_all();
+		for (std::thread& t : threads_) t.join();
+	}
+
+	size_t size() const noexcept { return workers_.size(); }
+};
+
+inline void WorkStealingPool::execute(Task* task) {
+	std::unique_ptr<Task> owned(task);
+	std::exception_ptr error;
+	try {
+		owned->fn();
+	} catch (...) {
+		error = std::current_exception();
+	}
+	owned->group->finish(std::move(error));
+}
@@ -10,6 +10,15 @@
 #include "BenchmarkDequeue.h"
 #include "BenchmarkQueue.h"
 #include "BenchmarkList.h"
+#include "BenchmarkLatency.h"
+#include "BenchmarkGrowth.h"
+#include "BenchmarkSimd.h"
+#include "BenchmarkParallel.h"
+#include "BenchmarkSpsc.h"
+#include "BenchmarkChannel.h"
+#include "BenchmarkWorkStealing.h"
+#include "BenchmarkAsync.h"
+#include "BenchmarkSnapshot.h"
 
 void checkValidity() {
     ShiftToMiddleArray<int> stmArray;
@@ -68,8 +77,29 @@ int main() {
     checkValidity();
 
     run_benchmarks_queue(40000);
+    run_benchmarks_relocation(40000);
+    run_benchmarks_arena(40000);
+    run_benchmarks_recentering(1000000);
+    run_benchmarks_sweep();
+    run_benchmarks_small_queues(1000000);
+    run_benchmarks_simd();
+    run_benchmarks_parallel(20000000);
+    run_benchmarks_spsc(5000000);
+    run_benchmarks_channel(2000000);
+    run_benchmarks_work_stealing();
+    run_benchmarks_async(1000000);
+    run_benchmarks_snapshot(5000000);
+    run_benchmarks_latency(200000);
+    run_benchmarks_large_copy();
+    run_benchmarks_growth();
+#ifdef __linux__
+    run_benchmarks_vm_growth();
+    run_benchmarks_shrink_release();
+#endif
     run_benchmarks_deque(40000);
+    run_benchmarks_deque_skew(40000);
     run_benchmarks_list(100000);
+    run_benchmarks_list_batched(2000);
 
     return 0;
 }
@@ -1,10 +1,43 @@
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ShiftToMiddleArray.h"
+#include "IncrementalShiftToMiddleArray.h"
+#include "ParallelAlgorithms.h"
+#include "StaticShiftToMiddleArray.h"
+#ifdef __linux__
+#include "VirtualMemoryAllocator.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+template <typename U, typename D>
+struct stm::is_trivially_relocatable<std::unique_ptr<U, D>> : std::true_type {};
+
+struct CountingPayload {
+    static inline int copies = 0;
+    int value;
+    explicit CountingPayload(int v) : value(v) {}
+    CountingPayload(const CountingPayload& o) : value(o.value) { ++copies; }
+    CountingPayload(CountingPayload&& o) noexcept : value(o.value) { o.value = -1; }
+    CountingPayload& operator=(const CountingPayload&) = default;
+    CountingPayload& operator=(CountingPayload&&) noexcept = default;
+};
 
 static void test_aliases_and_capacity() {
     ShiftToMiddleArray<int> s(16);
@@ -117,6 +150,1287 @@ static void test_random_access_iterator_ops() {
     assert((s.begin() + 4) > (s.begin() + 1));
 }
 
+static void test_relocation_moves_non_trivial() {
+    CountingPayload::copies = 0;
+    ShiftToMiddleArray<CountingPayload> s(2);
+    for (int i = 0; i < 200; ++i) {
+        if (i % 3 == 0) s.push_front(CountingPayload(i));
+        else s.push_back(CountingPayload(i));
+    }
+    for (int i = 0; i < 50; ++i) s.delete_at(static_cast<size_t>(i * 7) % s.size());
+    assert(CountingPayload::copies == 0);
+    for (size_t i = 0; i < s.size(); ++i) assert(s[i].value >= 0);
+}
+
+static void test_trivially_relocatable_unique_ptr() {
+    ShiftToMiddleArray<std::unique_ptr<int>> s(1);
+    for (int i = 0; i < 100; ++i) {
+        s.push_back(std::make_unique<int>(i));
+        s.push_front(std::make_unique<int>(-i));
+    }
+    assert(s.size() == 200);
+    assert(*s.front() == -99 && *s.back() == 99);
+    s.delete_at(100);
+    assert(*s[100] == 1);
+    s.pop_front();
+    s.pop_back();
+    assert(s.size() == 197 && *s.front() == -98 && *s.back() == 98);
+}
+
+static void test_pmr_arena_allocation() {
+    alignas(std::max_align_t) static std::byte buffer[1 << 16];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    stm::pmr::ShiftToMiddleArray<int> s(&arena);
+    for (int i = 0; i < 500; ++i) (i % 2) ? s.push_back(i) : s.push_front(i);
+    assert(s.size() == 500);
+    assert(s.get_allocator().resource() == &arena);
+
+    // Copies go back to the default resource, allocator-extended copies stay put
+    stm::pmr::ShiftToMiddleArray<int> copy(s);
+    assert(copy == s && copy.get_allocator().resource() == std::pmr::get_default_resource());
+    stm::pmr::ShiftToMiddleArray<int> arena_copy(s, &arena);
+    assert(arena_copy == s && arena_copy.get_allocator().resource() == &arena);
+
+    // Unequal resources without propagation: elements are moved, not the block
+    stm::pmr::ShiftToMiddleArray<int> other;
+    other = std::move(arena_copy);
+    assert(other == s && other.get_allocator().resource() == std::pmr::get_default_resource());
+}
+
+static void test_pmr_non_trivial_elements() {
+    std::pmr::monotonic_buffer_resource arena;
+    stm::pmr::ShiftToMiddleArray<std::pmr::string> s(&arena);
+    for (int i = 0; i < 64; ++i) s.push_back(std::pmr::string(40, static_cast<char>('a' + i % 26)));
+    s.insert(10, std::pmr::string("middle"));
+    s.delete_at(0);
+    assert(s.size() == 64 && s[9] == "middle");
+    assert(s[10].get_allocator().resource() == &arena);
+}
+
+static void test_bulk_append_prepend_assign() {
+    static_assert(std::ranges::contiguous_range<ShiftToMiddleArray<int>>);
+
+    std::vector<int> v(1000);
+    for (int i = 0; i < 1000; ++i) v[i] = i;
+
+    ShiftToMiddleArray<int> s;
+    s.append_range(std::span<const int>(v));
+    assert(s.size() == 1000 && s.front() == 0 && s.back() == 999);
+    assert(s.capacity() - s.size() >= 1000 / 2); // grown once, with headroom
+
+    s.prepend_range(std::list<int>{-3, -2, -1});
+    std::istringstream tail_in("1000 1001");
+    s.append_range(std::istream_iterator<int>(tail_in), std::istream_iterator<int>());
+    std::istringstream head_in("-5 -4");
+    s.prepend_range(std::istream_iterator<int>(head_in), std::istream_iterator<int>());
+    assert(s.size() == 1007);
+    for (size_t i = 0; i < s.size(); ++i) assert(s[i] == static_cast<int>(i) - 5);
+
+    ShiftToMiddleArray<int> copy;
+    copy.assign_range(s);
+    assert(copy == s);
+    copy.assign({4, 5, 6});
+    assert(copy.size() == 3 && copy[0] == 4 && copy[2] == 6);
+
+    ShiftToMiddleArray<std::string> strings;
+    strings.assign(3, "z");
+    strings.prepend_range(std::vector<std::string>{"x", "y"});
+    assert(strings.size() == 5 && strings[0] == "x" && strings[1] == "y" && strings[4] == "z");
+    strings.clear();
+    assert(strings.empty());
+}
+
+static void test_reserve_front_back() {
+    ShiftToMiddleArray<int> s;
+    for (int i = 0; i < 10; ++i) s.push_back(i);
+
+    s.reserve_front(1000);
+    assert(s.front_capacity() >= 1000);
+    [[maybe_unused]] const size_t back_slack = s.back_capacity();
+    [[maybe_unused]] const size_t capacity = s.capacity();
+    [[maybe_unused]] const int* anchor = &s.back();
+    for (int i = 0; i < 1000; ++i) s.push_front(-i);
+    assert(s.capacity() == capacity && &s.back() == anchor); // no resize, no shift
+    assert(s.back_capacity() == back_slack);
+
+    s.reserve_back(500);
+    assert(s.back_capacity() >= 500);
+    s.reserve(2000);
+    assert(s.front_capacity() >= 2000 && s.back_capacity() >= 2000);
+    [[maybe_unused]] const size_t reserved = s.capacity();
+    s.reserve(10);
+    assert(s.capacity() == reserved);
+    assert(s.size() == 1010 && s.front() == -999 && s.back() == 9);
+}
+
+// Counts live objects
+struct Tracked {
+    static inline int live = 0;
+    Tracked() { ++live; }
+    Tracked(const Tracked&) noexcept { ++live; }
+    ~Tracked() { --live; }
+};
+
+struct ShrinkingPolicy : stm::DefaultPolicy {
+    static constexpr bool allow_shrinking = true;
+};
+
+struct UncheckedCenteredPolicy : stm::DefaultPolicy {
+    static constexpr bool bounds_check = false;
+    static constexpr float bias_step = 0.0f;
+};
+
+struct AlwaysCleanupPolicy : stm::DefaultPolicy {
+    static constexpr stm::CleanupMode cleanup = stm::CleanupMode::Always;
+};
+
+struct TripleGrowthPolicy : stm::DefaultPolicy {
+    struct growth : stm::GeometricGrowth {
+        static constexpr size_t next_capacity(size_t capacity, size_t required, size_t, size_t) noexcept {
+            return std::max(capacity * 3, required);
+        }
+    };
+};
+
+static void test_policy_configuration() {
+    // Differently tuned instances coexist in one translation unit
+    ShiftToMiddleArray<int, 2, std::allocator<int>, ShrinkingPolicy> shrinking(8);
+    ShiftToMiddleArray<int> fixed(8);
+    for (int i = 0; i < 4096; ++i) {
+        shrinking.push_back(i);
+        fixed.push_back(i);
+    }
+    const size_t peak = fixed.capacity();
+    for (int i = 0; i < 4090; ++i) {
+        shrinking.pop_front();
+        fixed.pop_front();
+    }
+    assert(fixed.capacity() == peak);
+    assert(shrinking.capacity() < peak / 8);
+    assert(shrinking.size() == 6 && shrinking.front() == 4090 && shrinking.back() == 4095);
+
+    // Without bias every growth recenters exactly; the default leans towards the pushed side
+    ShiftToMiddleArray<int, 2, std::allocator<int>, UncheckedCenteredPolicy> centered(4);
+    ShiftToMiddleArray<int> biased(4);
+    size_t capacity = centered.capacity();
+    for (int i = 0; i < 1000; ++i) {
+        centered.push_back(i);
+        biased.push_back(i);
+        if (centered.capacity() != capacity) {
+            capacity = centered.capacity();
+            assert(centered.front_capacity() >= centered.back_capacity());
+            assert(centered.front_capacity() - centered.back_capacity() <= 2);
+        }
+    }
+    assert(biased.front_capacity() < biased.back_capacity());
+    assert(centered[999] == 999);
+
+    ShiftToMiddleArray<int, 2, std::allocator<int>, TripleGrowthPolicy> triple(4);
+    for (int i = 0; i < 5; ++i) triple.push_back(i);
+    assert(triple.capacity() == 12);
+
+    // Always-cleanup destroys removed elements
+    {
+        ShiftToMiddleArray<Tracked, 2, std::allocator<Tracked>, AlwaysCleanupPolicy> tracked;
+        for (int i = 0; i < 10; ++i) tracked.push_back(Tracked());
+        tracked.pop_front();
+        tracked.pop_back();
+        assert(Tracked::live == 8);
+    }
+    assert(Tracked::live == 0);
+}
+
+struct AdaptiveBiasPolicy : stm::DefaultPolicy {
+    static constexpr bool adaptive_bias = true;
+};
+
+struct AdaptiveGrowthPolicy : stm::DefaultPolicy {
+    using growth = stm::AdaptiveGrowth<(1 << 16)>;
+};
+
+static void test_adaptive_growth() {
+    using G = stm::AdaptiveGrowth<(1 << 16)>;
+    // Small blocks double and land on power-of-two byte sizes
+    static_assert(G::next_capacity(3, 5, 2, 4) == 8);
+    static_assert(G::next_capacity(100, 102, 2, 4) == 256);
+    // Large blocks grow by 1.5x, rounded to whole pages
+    static_assert(G::next_capacity(100000, 100002, 2, 4) == 150528);
+    static_assert(G::next_capacity(100000, 100002, 2, 4) * 4 % 4096 == 0);
+    static_assert(G::next_capacity(100000, 400000, 2, 4) >= 400000);
+    static_assert(stm::GeometricGrowth::next_capacity(100000, 100002, 2, 4) == 200000);
+
+    // Past the threshold the unused capacity stays within half of the contents
+    ShiftToMiddleArray<int, 2, std::allocator<int>, AdaptiveGrowthPolicy> s(8);
+    for (int i = 0; i < 1000000; ++i) {
+        s.push_back(i);
+        if (s.capacity() * sizeof(int) > (1 << 17)) assert(s.capacity() <= s.size() * 3 / 2 + 4096);
+    }
+    assert(s.capacity() * sizeof(int) % 4096 == 0);
+    assert(s.size() == 1000000 && s[999999] == 999999);
+}
+
+static void test_adaptive_bias_follows_workload() {
+    // 90% push_back / 10% push_front: the tail gets ~90% of the slack at every growth
+    ShiftToMiddleArray<int, 2, std::allocator<int>, AdaptiveBiasPolicy> s(16);
+    std::mt19937 rng(3);
+    size_t capacity = s.capacity(), growths = 0;
+    for (int i = 0; i < 200000; ++i) {
+        if (rng() % 10 == 0) s.push_front(i);
+        else s.push_back(i);
+        if (s.capacity() != capacity) {
+            capacity = s.capacity();
+            const double back_share = double(s.back_capacity()) / double(s.front_capacity() + s.back_capacity());
+            if (++growths > 3) assert(back_share > 0.8 && back_share < 0.97);
+        }
+    }
+    assert(growths > 8);
+
+    // Pure FIFO leaves only the minimum share in front after a recentering
+    ShiftToMiddleArray<int, 2, std::allocator<int>, AdaptiveBiasPolicy> q(1024);
+    for (int i = 0; i < 100; ++i) q.push_back(i);
+    for (int i = 0; i < 10000; ++i) {
+        q.push_back(i);
+        q.pop_front();
+    }
+    assert(q.capacity() == 1024);
+    assert(q.front_capacity() < q.back_capacity());
+
+    // Stays consistent with std::deque under mixed traffic
+    ShiftToMiddleArray<int, 2, std::allocator<int>, AdaptiveBiasPolicy> mixed(2);
+    std::deque<int> ref;
+    for (int i = 0; i < 100000; ++i) {
+        switch (rng() % 5) {
+            case 0: mixed.push_front(i); ref.push_front(i); break;
+            case 1: case 2: mixed.push_back(i); ref.push_back(i); break;
+            case 3: if (!ref.empty()) { mixed.pop_front(); ref.pop_front(); } break;
+            case 4: if (!ref.empty()) { mixed.pop_back(); ref.pop_back(); } break;
+        }
+    }
+    assert(mixed.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i) assert(mixed[i] == ref[i]);
+}
+
+struct CenteringStatsPolicy : stm::DefaultPolicy {
+    static constexpr unsigned drift_threshold = 0;
+    static constexpr bool collect_stats = true;
+};
+
+struct DriftStatsPolicy : stm::DefaultPolicy {
+    static constexpr bool collect_stats = true;
+};
+
+static void test_drift_aware_recentering() {
+    // Steady FIFO drift: parking the window at the far end halves the shifts
+    ShiftToMiddleArray<int, 2, std::allocator<int>, CenteringStatsPolicy> centered(4096);
+    ShiftToMiddleArray<int, 2, std::allocator<int>, DriftStatsPolicy> drifting(4096);
+    for (int i = 0; i < 1000; ++i) {
+        centered.push_back(i);
+        drifting.push_back(i);
+    }
+    centered.reset_stats();
+    drifting.reset_stats();
+    for (int i = 0; i < 200000; ++i) {
+        centered.push_back(i);
+        centered.pop_front();
+        drifting.push_back(i);
+        drifting.pop_front();
+    }
+    assert(centered.capacity() == 4096 && drifting.capacity() == 4096);
+    assert(centered.stats().reallocations == 0 && drifting.stats().reallocations == 0);
+    assert(drifting.stats().shifts * 10 < centered.stats().shifts * 6);
+    assert(drifting.stats().bytes_moved * 10 < centered.stats().bytes_moved * 6);
+    assert(drifting.front() == 199000 && drifting.back() == 199999);
+
+    // Mirror image: LIFO-at-the-front drift towards the front end
+    ShiftToMiddleArray<int, 2, std::allocator<int>, DriftStatsPolicy> reverse(4096);
+    for (int i = 0; i < 1000; ++i) reverse.push_front(i);
+    for (int i = 0; i < 200000; ++i) {
+        reverse.push_front(i);
+        reverse.pop_back();
+    }
+    assert(reverse.size() == 1000 && reverse.front() == 199999 && reverse.back() == 199000);
+
+    // Alternating ends never count as drift
+    ShiftToMiddleArray<int, 2, std::allocator<int>, DriftStatsPolicy> mixed(64);
+    std::deque<int> ref;
+    std::mt19937 rng(11);
+    for (int i = 0; i < 100000; ++i) {
+        switch (rng() % 4) {
+            case 0: mixed.push_front(i); ref.push_front(i); break;
+            case 1: mixed.push_back(i); ref.push_back(i); break;
+            case 2: if (!ref.empty()) { mixed.pop_front(); ref.pop_front(); } break;
+            case 3: if (!ref.empty()) { mixed.pop_back(); ref.pop_back(); } break;
+        }
+    }
+    assert(mixed.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i) assert(mixed[i] == ref[i]);
+}
+
+struct RingPolicy : stm::DefaultPolicy {
+    static constexpr bool ring_wrap = true;
+    static constexpr bool collect_stats = true;
+};
+
+template <typename A>
+concept ConstContiguous = requires (const A& a) { a.begin(); a.data(); };
+
+static void test_ring_wrap_mode() {
+    // Sustained FIFO traffic wraps instead of shifting
+    ShiftToMiddleArray<int, 2, std::allocator<int>, RingPolicy> q(1024);
+    for (int i = 0; i < 300; ++i) q.push_back(i);
+    bool saw_wrap = false;
+    for (int i = 300; i < 4000; ++i) {
+        q.push_back(i);
+        q.pop_front();
+        saw_wrap = saw_wrap || !q.is_contiguous();
+    }
+    assert(saw_wrap);
+    q.reset_stats();
+    for (int i = 4000; i < 200000; ++i) {
+        q.push_back(i);
+        q.pop_front();
+        assert(q.front() == i - 299 && q.back() == i && q[150] == i - 149);
+    }
+    assert(q.stats().shifts == 0 && q.stats().reallocations == 0 && q.stats().bytes_moved == 0);
+    assert(q.capacity() == 1024 && q.size() == 300);
+
+    // Anything needing contiguity restores it
+    while (q.is_contiguous()) {
+        q.push_back(0);
+        q.pop_front();
+    }
+    auto copy = q;
+    assert(copy.is_contiguous() && copy == q);
+    const int* p = q.data();
+    assert(q.is_contiguous() && std::equal(p, p + q.size(), copy.begin()));
+
+    // ... except const access, which reads the wrapped window in place
+    while (q.is_contiguous()) {
+        q.push_back(static_cast<int>(q.size()));
+        q.pop_front();
+    }
+    const auto& cq = q;
+    static_assert(ConstContiguous<ShiftToMiddleArray<int>> && !ConstContiguous<std::remove_cvref_t<decltype(cq)>>);
+    int sum = 0, lo = cq[0], hi = cq[0];
+    for (size_t i = 0; i < cq.size(); ++i) { sum += cq[i]; lo = std::min(lo, cq[i]); hi = std::max(hi, cq[i]); }
+    assert(cq.sum() == sum && cq.min() == lo && cq.max() == hi);
+    std::stringstream saved;
+    cq.serialize(saved);
+    assert(!q.is_contiguous());
+    ShiftToMiddleArray<int, 2, std::allocator<int>, RingPolicy> restored(q.capacity());
+    assert(restored.deserialize(saved) && restored == q);
+
+    // A full ring grows like a contiguous array
+    while (q.is_contiguous()) {
+        q.push_back(0);
+        q.pop_front();
+    }
+    const size_t capacity = q.capacity();
+    for (int i = 0; i < 2000; ++i) q.push_back(i);
+    assert(q.capacity() > capacity && q.back() == 1999);
+
+    // Random traffic at both ends against std::deque
+    ShiftToMiddleArray<std::string, 2, std::allocator<std::string>, RingPolicy> mixed(16);
+    std::deque<std::string> ref;
+    std::mt19937 rng(5);
+    for (int i = 0; i < 200000; ++i) {
+        const std::string v = std::to_string(i);
+        const unsigned op = rng() % 100;
+        if (op < 45) { mixed.push_back(v); ref.push_back(v); }
+        else if (op < 90) { if (!ref.empty()) { mixed.pop_front(); ref.pop_front(); } }
+        else if (op < 94) { if (!ref.empty()) { mixed.pop_back(); ref.pop_back(); } }
+        else if (op < 96) { mixed.push_front(v); ref.push_front(v); }
+        else if (op < 97) { const size_t at = ref.empty() ? 0 : rng() % ref.size(); mixed.insert(at, v); ref.insert(ref.begin() + static_cast<std::ptrdiff_t>(at), v); }
+        else if (!ref.empty()) { const size_t k = rng() % ref.size(); assert(mixed[k] == ref[k]); }
+        assert(mixed.size() == ref.size());
+        if (!ref.empty()) assert(mixed.front() == ref.front() && mixed.back() == ref.back());
+    }
+    assert(std::equal(mixed.begin(), mixed.end(), ref.begin(), ref.end()));
+}
+
+// Arguments that are references to (or ranges of) the array's own elements
+// stay valid while the member unwraps, recenters or grows the array
+static void test_self_aliasing_arguments() {
+    const auto str = [](int i) { return std::string(32, 'x') + std::to_string(i); };
+    using Ring = ShiftToMiddleArray<std::string, 2, std::allocator<std::string>, RingPolicy>;
+    Ring q(64);
+    std::deque<std::string> ref;
+    int next = 0;
+    const auto wrap = [&] {
+        while (ref.size() < 20) { q.push_back(str(next)); ref.push_back(str(next++)); }
+        do {
+            q.push_back(str(next));
+            ref.push_back(str(next++));
+            q.pop_front();
+            ref.pop_front();
+        } while (q.is_contiguous());
+    };
+    const auto same = [&] { return q.size() == ref.size() && std::equal(q.begin(), q.end(), ref.begin(), ref.end()); };
+
+    wrap();
+    q.push_front(q.back());
+    ref.push_front(ref.back());
+    assert(same());
+    wrap();
+    q.push_front(std::move(q[3]));
+    ref.push_front(std::move(ref[3]));
+    assert(same());
+    wrap();
+    q.insert(5, q[q.size() - 2]);
+    ref.insert(ref.begin() + 5, ref[ref.size() - 2]);
+    assert(same());
+    wrap();
+    const std::span<std::string> head = q.front_span(4);
+    q.append_range(head.begin(), head.end());
+    const std::vector<std::string> ref_head(ref.begin(), ref.begin() + static_cast<std::ptrdiff_t>(head.size()));
+    ref.insert(ref.end(), ref_head.begin(), ref_head.end());
+    assert(same());
+    wrap();
+    const std::span<std::string> last = q.back_span(3);
+    q.prepend_range(last.begin(), last.end());
+    const std::vector<std::string> ref_last(ref.end() - static_cast<std::ptrdiff_t>(last.size()), ref.end());
+    ref.insert(ref.begin(), ref_last.begin(), ref_last.end());
+    assert(same());
+    wrap();
+    assert(q.count(q.back()) == 1 && q.contains(q.back()));
+    wrap();
+    const std::string wanted = q.back();
+    assert(*q.find(q.back()) == wanted);
+
+    // A full ring: push_back unwraps and grows
+    wrap();
+    while (!q.is_contiguous()) {
+        q.push_back(q.front());
+        ref.push_back(ref.front());
+    }
+    assert(same());
+
+    // Outside ring mode: growth and recentering at either end
+    ShiftToMiddleArray<std::string> a(4);
+    std::deque<std::string> expected;
+    for (int i = 0; i < 2000; ++i) {
+        if (a.empty() || i % 5 == 0) { a.push_back(str(i)); expected.push_back(str(i)); }
+        else if (i % 5 == 1) { a.push_back(a.front()); expected.push_back(expected.front()); }
+        else if (i % 5 == 2) { a.push_front(a.back()); expected.push_front(expected.back()); }
+        else if (i % 5 == 3) { a.insert(a.size() / 2, a.front()); expected.insert(expected.begin() + static_cast<std::ptrdiff_t>(expected.size() / 2), expected.front()); }
+        else { a.pop_front(); expected.pop_front(); }
+    }
+    assert(std::equal(a.begin(), a.end(), expected.begin(), expected.end()));
+}
+
+static void test_bulk_consume() {
+    ShiftToMiddleArray<int> a;
+    for (int i = 0; i < 100; ++i) a.push_back(i);
+
+    std::span<int> first = a.front_span(10);
+    assert(first.size() == 10 && first.data() == &a.front() && first[9] == 9);
+    assert(a.pop_front_n(10) == 10 && a.front() == 10 && a.size() == 90);
+    std::span<const int> last = std::as_const(a).back_span(5);
+    assert(last.size() == 5 && last[0] == 95 && &last[4] == &a.back());
+    assert(a.pop_back_n(5) == 5 && a.back() == 94);
+    assert(a.front_span(1000).size() == 85 && a.pop_front_n(1000) == 85 && a.empty());
+    assert(a.pop_back_n(3) == 0 && a.front_span(3).empty());
+
+    // Non-trivial elements are destroyed; shrinking runs once per batch
+    {
+        ShiftToMiddleArray<Tracked, 2, std::allocator<Tracked>, ShrinkingPolicy> t(8);
+        for (int i = 0; i < 1000; ++i) t.push_back(Tracked{});
+        assert(Tracked::live == 1000);
+        t.pop_front_n(600);
+        t.pop_back_n(350);
+        assert(Tracked::live == 50 && t.size() == 50 && t.capacity() < 1000);
+    }
+    assert(Tracked::live == 0);
+
+    // Ring mode: spans stop at the block edge, batches cross it
+    ShiftToMiddleArray<std::string, 2, std::allocator<std::string>, RingPolicy> q(64);
+    std::deque<std::string> ref;
+    std::mt19937 rng(11);
+    int next = 0;
+    bool saw_short_span = false;
+    for (int round = 0; round < 20000; ++round) {
+        for (unsigned k = rng() % 8; k > 0; --k) {
+            q.push_back(std::to_string(next));
+            ref.push_back(std::to_string(next++));
+        }
+        const size_t n = rng() % 8;
+        const std::span<std::string> view = q.front_span(n);
+        saw_short_span = saw_short_span || view.size() < std::min(n, ref.size());
+        assert(std::equal(view.begin(), view.end(), ref.begin()));
+        if (rng() % 4 == 0) {
+            const std::span<std::string> tail = q.back_span(n);
+            assert(std::equal(tail.begin(), tail.end(), ref.end() - static_cast<std::ptrdiff_t>(tail.size())));
+            const size_t popped = q.pop_back_n(n);
+            assert(popped == std::min(n, ref.size()));
+            ref.erase(ref.end() - static_cast<std::ptrdiff_t>(popped), ref.end());
+        } else {
+            const size_t popped = q.pop_front_n(n);
+            assert(popped == std::min(n, ref.size()));
+            ref.erase(ref.begin(), ref.begin() + static_cast<std::ptrdiff_t>(popped));
+        }
+        assert(q.size() == ref.size());
+        if (!ref.empty()) assert(q.front() == ref.front() && q.back() == ref.back());
+    }
+    assert(saw_short_span);
+    assert(std::equal(q.begin(), q.end(), ref.begin(), ref.end()));
+}
+
+// Copy constructor throws once the budget of allowed copies is used up
+struct CopyBudget {
+    static inline int copies_left = -1;  // < 0: unlimited
+    int v = 0;
+    explicit CopyBudget(int x) : v(x) {}
+    CopyBudget(const CopyBudget& o) : v(o.v) {
+        if (copies_left == 0) throw std::runtime_error("copy budget exhausted");
+        if (copies_left > 0) --copies_left;
+    }
+    CopyBudget(CopyBudget&&) noexcept = default;
+    CopyBudget& operator=(const CopyBudget&) = default;
+};
+
+static void test_range_insert_erase() {
+    // Random middle edits against std::vector
+    ShiftToMiddleArray<std::string> a(4);
+    std::vector<std::string> ref;
+    std::mt19937 rng(3);
+    for (int round = 0; round < 5000; ++round) {
+        const size_t at = rng() % (ref.size() + 1);
+        switch (rng() % 4) {
+            case 0: {
+                std::vector<std::string> batch(rng() % 20);
+                for (auto& x : batch) x = std::to_string(rng());
+                a.insert(at, batch.begin(), batch.end());
+                ref.insert(ref.begin() + static_cast<std::ptrdiff_t>(at), batch.begin(), batch.end());
+                break;
+            }
+            case 1: {
+                const size_t count = rng() % 20;
+                const std::string v = std::to_string(round);
+                a.insert(at, count, v);
+                ref.insert(ref.begin() + static_cast<std::ptrdiff_t>(at), count, v);
+                break;
+            }
+            default: {
+                const size_t last = std::min(ref.size(), at + rng() % 30);
+                a.erase(at, last);
+                ref.erase(ref.begin() + static_cast<std::ptrdiff_t>(at), ref.begin() + static_cast<std::ptrdiff_t>(last));
+                break;
+            }
+        }
+        assert(std::equal(a.begin(), a.end(), ref.begin(), ref.end()));
+    }
+
+    // Iterator overloads, single-pass input and self-referencing values
+    ShiftToMiddleArray<int> b;
+    for (int i = 0; i < 10; ++i) b.push_back(i);
+    auto it = b.insert(b.cbegin() + 3, 2, 100);
+    assert(*it == 100 && it - b.begin() == 3 && b.size() == 12);
+    std::istringstream in("7 8 9");
+    b.insert_range(1, std::ranges::istream_view<int>(in));
+    assert(b[1] == 7 && b[3] == 9 && b[4] == 1 && b.size() == 15);
+    it = b.erase(b.begin() + 1, b.begin() + 4);
+    assert(*it == 1 && b.size() == 12);
+    it = b.erase(b.begin());
+    assert(*it == 1 && b.front() == 1);
+    b.insert(0, 5, b.back());
+    assert(b.front() == 9 && b[4] == 9 && b[5] == 1);
+    b.insert(b.size(), 5000, b.front());
+    assert(b.size() == 5016 && b.back() == 9);
+    b.erase(0, b.size());
+    assert(b.empty());
+
+    // Values and ranges taken from the array itself, also while it wraps
+    ShiftToMiddleArray<std::string, 2, std::allocator<std::string>, RingPolicy> r(32);
+    std::vector<std::string> rref;
+    auto wrap = [&, next = 0]() mutable {
+        do {
+            r.push_back(std::string(32, 'y') + std::to_string(next));
+            rref.push_back(std::string(32, 'y') + std::to_string(next++));
+            while (r.size() > 12) { r.pop_front(); rref.erase(rref.begin()); }
+        } while (r.is_contiguous());
+    };
+    wrap();
+    r.insert(4, 3, r.back());
+    rref.insert(rref.begin() + 4, 3, std::string(rref.back()));
+    assert(std::equal(r.begin(), r.end(), rref.begin(), rref.end()));
+    wrap();
+    const std::span<std::string> run = r.front_span(5);
+    r.insert(7, run.begin(), run.end());
+    const std::vector<std::string> ref_run(rref.begin(), rref.begin() + static_cast<std::ptrdiff_t>(run.size()));
+    rref.insert(rref.begin() + 7, ref_run.begin(), ref_run.end());
+    assert(std::equal(r.begin(), r.end(), rref.begin(), rref.end()));
+    for (int i = 0; i < 40; ++i) b.push_back(i);
+    b.insert(b.cbegin() + 2, b.rbegin(), b.rend());
+    assert(b.size() == 80 && b[1] == 1 && b[2] == 39 && b[41] == 0 && b[42] == 2);
+
+    // A throwing element constructor leaves the previous contents
+    ShiftToMiddleArray<CopyBudget> c(8);
+    for (int i = 0; i < 6; ++i) c.push_back(CopyBudget(i));
+    std::vector<CopyBudget> batch;
+    for (int i = 0; i < 40; ++i) batch.emplace_back(100 + i);
+    CopyBudget::copies_left = 10;
+    bool thrown = false;
+    try { c.insert(3, batch.begin(), batch.end()); } catch (const std::runtime_error&) { thrown = true; }
+    CopyBudget::copies_left = -1;
+    assert(thrown && c.size() == 6);
+    for (int i = 0; i < 6; ++i) assert(c[i].v == i);
+}
+
+static void test_erase_if_and_unique() {
+    // Removal patterns that favour either compaction direction, against std::vector
+    std::mt19937 rng(8);
+    for (int round = 0; round < 400; ++round) {
+        // Zeros (the removed value) only occur within a random window of positions
+        const size_t n = rng() % 300;
+        const size_t lo = n ? rng() % n : 0, hi = lo + (n ? rng() % (n - lo + 1) : 0);
+        std::vector<int> ref;
+        for (size_t i = 0; i < n; ++i) {
+            ref.push_back(i >= lo && i < hi ? static_cast<int>(rng() % 4) : 1 + static_cast<int>(rng() % 3));
+        }
+        ShiftToMiddleArray<int> a(4);
+        ShiftToMiddleArray<std::string> b(4);
+        for (size_t i = n; i-- > n / 2;) { a.push_front(ref[i]); b.push_front(std::to_string(ref[i])); }
+        for (size_t i = 0; i < n / 2; ++i) { a.insert(i, ref[i]); b.insert(i, std::to_string(ref[i])); }
+        assert(std::equal(a.begin(), a.end(), ref.begin(), ref.end()));
+
+        std::vector<int> expected;
+        for (int v : ref) if (v != 0) expected.push_back(v);
+        size_t calls = 0;
+        const size_t removed = a.erase_if([&](const int& v) { ++calls; return v == 0; });
+        const size_t removed_strings = b.erase_if([](const std::string& v) { return v == "0"; });
+        assert(calls == ref.size());
+        assert(removed == ref.size() - expected.size() && removed_strings == removed);
+        assert(std::equal(a.begin(), a.end(), expected.begin(), expected.end()));
+        for (size_t i = 0; i < expected.size(); ++i) assert(b[i] == std::to_string(expected[i]));
+
+        const size_t dups = a.unique();
+        const size_t dup_strings = b.unique();
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        assert(dups == dup_strings && a.size() == expected.size());
+        assert(std::equal(a.begin(), a.end(), expected.begin(), expected.end()));
+        for (size_t i = 0; i < expected.size(); ++i) assert(b[i] == std::to_string(expected[i]));
+    }
+
+    // Non-trivial elements are destroyed exactly once
+    {
+        ShiftToMiddleArray<Tracked> t;
+        for (int i = 0; i < 100; ++i) t.push_back(Tracked{});
+        size_t k = 0;
+        assert(t.erase_if([&](const Tracked&) { return k++ % 3 == 0; }) == 34);
+        assert(Tracked::live == 66);
+        assert(t.unique([](const Tracked&, const Tracked&) { return true; }) == 65 && Tracked::live == 1);
+    }
+    assert(Tracked::live == 0);
+
+    // A throwing predicate keeps everything it has not removed yet
+    for (int start = 0; start < 2; ++start) {
+        ShiftToMiddleArray<std::string> s;
+        for (int i = 0; i < 50; ++i) s.push_back(std::to_string(i));
+        int calls = 0;
+        bool thrown = false;
+        try {
+            // The removal closest to an end decides the direction: the back for
+            // start == 0 (first removal at 0), the front otherwise (last at 49)
+            s.erase_if([&](const std::string& v) {
+                if (++calls == 12) throw std::runtime_error("predicate failed");
+                const int x = std::stoi(v);
+                return start ? (x == 49 || (x > 0 && x % 7 == 0)) : (x == 0 || x % 7 == 6);
+            });
+        } catch (const std::runtime_error&) { thrown = true; }
+        assert(thrown);
+        std::vector<int> left;
+        for (const auto& v : s) left.push_back(std::stoi(v));
+        assert(std::is_sorted(left.begin(), left.end()));
+        assert(std::adjacent_find(left.begin(), left.end()) == left.end());
+        assert(left.size() >= 40);
+    }
+}
+
+// Counts heap blocks handed out, to tell inline storage from allocations
+template <typename T>
+struct CountingAlloc {
+    using value_type = T;
+    static inline int blocks = 0;
+    CountingAlloc() = default;
+    template <typename U> CountingAlloc(const CountingAlloc<U>&) noexcept {}
+    T* allocate(size_t n) { ++blocks; return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, size_t n) noexcept { --blocks; std::allocator<T>().deallocate(p, n); }
+    friend bool operator==(const CountingAlloc&, const CountingAlloc&) { return true; }
+};
+
+static void test_small_inline_storage() {
+    using Small = SmallShiftToMiddleArray<int, 16, CountingAlloc<int>>;
+    static_assert(sizeof(ShiftToMiddleArray<int>) == sizeof(ShiftToMiddleArray<int, 2, std::allocator<int>, stm::DefaultPolicy>));
+    static_assert(sizeof(Small) >= 16 * sizeof(int));
+
+    {
+        // Up to N elements: no allocation, centered like the heap version
+        Small a;
+        assert(a.capacity() == 16 && CountingAlloc<int>::blocks == 0);
+        for (int i = 0; i < 8; ++i) { a.push_back(i); a.push_front(-i); }
+        assert(a.size() == 16 && CountingAlloc<int>::blocks == 0);
+
+        // Spilling goes through the usual growth
+        a.push_back(100);
+        assert(a.capacity() > 16 && CountingAlloc<int>::blocks == 1);
+        for (int i = 0; i < 1000; ++i) a.push_back(i);
+        a.erase(4, a.size());
+        a.shrink_to_fit();
+        assert(CountingAlloc<int>::blocks == 0 && a.size() == 4 && a[0] == -7 && a[3] == -4);
+    }
+    assert(CountingAlloc<int>::blocks == 0);
+
+    // Move, copy and swap between inline and heap storage, with non-trivial elements
+    using SmallStrings = SmallShiftToMiddleArray<std::string, 4>;
+    const auto make = [](int n, const char* tag) {
+        SmallStrings s;
+        for (int i = 0; i < n; ++i) s.push_back(tag + std::to_string(i));
+        return s;
+    };
+    const auto holds = [](const SmallStrings& s, int n, const char* tag) {
+        if (s.size() != static_cast<size_t>(n)) return false;
+        for (int i = 0; i < n; ++i) if (s[i] != tag + std::to_string(i)) return false;
+        return true;
+    };
+    SmallStrings in = make(3, "in");
+    SmallStrings out = make(40, "out");
+    SmallStrings moved(std::move(in));
+    assert(holds(moved, 3, "in") && in.empty());
+    in = moved;
+    assert(holds(in, 3, "in"));
+    swap(in, out);
+    assert(holds(in, 40, "out") && holds(out, 3, "in"));
+    SmallStrings other = make(2, "x");
+    swap(out, other);
+    assert(holds(out, 2, "x") && holds(other, 3, "in"));
+    out = std::move(in);
+    assert(holds(out, 40, "out"));
+    in.clear();
+    in.push_back("again");
+    assert(in.size() == 1 && in.front() == "again");
+
+    // Lives happily in a container of many tiny queues
+    std::vector<SmallShiftToMiddleArray<Tracked, 2>> queues(100);
+    for (auto& q : queues) { q.push_back(Tracked{}); q.push_back(Tracked{}); }
+    queues.resize(1000);
+    assert(Tracked::live == 200);
+    queues.clear();
+    assert(Tracked::live == 0);
+}
+
+// Built during constant evaluation
+constexpr auto static_squares = [] {
+    StaticShiftToMiddleArray<int, 16> a;
+    for (int i = 0; i < 8; ++i) a.push_front(i * i);
+    for (int i = 8; i < 16; ++i) a.push_back(i * i);  // recenters on the way
+    return a;
+}();
+static_assert(static_squares.full() && static_squares.front() == 49 && static_squares.back() == 225);
+static_assert(static_squares[7] == 0 && static_squares[8] == 64);
+
+static_assert([] {
+    StaticShiftToMiddleArray<std::string, 4, stm::OverflowPolicy::Overwrite> a{"a", "b", "c", "d"};
+    a.push_back("e");
+    a.insert(1, "x");
+    a.delete_at(0);
+    std::string joined;
+    for (const auto& s : a) joined += s;
+    return joined == "xcd";
+}() == true);
+
+// Counts move constructions
+struct MoveCounted {
+    static inline int moves = 0;
+    int value;
+    explicit MoveCounted(int v) : value(v) {}
+    MoveCounted(const MoveCounted&) = default;
+    MoveCounted(MoveCounted&& o) noexcept : value(o.value) { ++moves; }
+    MoveCounted& operator=(const MoveCounted&) = default;
+    MoveCounted& operator=(MoveCounted&&) noexcept = default;
+};
+
+static void test_static_array() {
+    // Matches std::deque until full; recentering never loses elements
+    StaticShiftToMiddleArray<std::string, 32> a;
+    std::deque<std::string> ref;
+    std::mt19937 rng(21);
+    for (int i = 0; i < 20000; ++i) {
+        const std::string v = std::to_string(i);
+        const unsigned op = rng() % 10;
+        if (ref.size() < 32 && op < 3) { a.push_back(v); ref.push_back(v); }
+        else if (ref.size() < 32 && op < 6) { a.push_front(v); ref.push_front(v); }
+        else if (ref.size() < 32 && op < 7) {
+            const size_t at = rng() % (ref.size() + 1);
+            a.insert(at, v);
+            ref.insert(ref.begin() + static_cast<std::ptrdiff_t>(at), v);
+        } else if (!ref.empty() && op < 8) {
+            const size_t at = rng() % ref.size();
+            a.delete_at(at);
+            ref.erase(ref.begin() + static_cast<std::ptrdiff_t>(at));
+        } else if (!ref.empty() && op < 9) { a.pop_front(); ref.pop_front(); }
+        else if (!ref.empty()) { a.pop_back(); ref.pop_back(); }
+        assert(std::equal(a.begin(), a.end(), ref.begin(), ref.end()));
+    }
+
+    // Overflow policies
+    StaticShiftToMiddleArray<int, 4> fail{1, 2, 3, 4};
+    bool thrown = false;
+    try { fail.push_back(5); } catch (const std::length_error&) { thrown = true; }
+    assert(thrown && fail.size() == 4 && fail.back() == 4);
+
+    StaticShiftToMiddleArray<int, 4, stm::OverflowPolicy::Drop> drop{1, 2, 3, 4};
+    assert(!drop.push_back(5) && !drop.push_front(0) && !drop.insert(2, 9));
+    assert((drop == StaticShiftToMiddleArray<int, 4, stm::OverflowPolicy::Drop>{1, 2, 3, 4}));
+
+    StaticShiftToMiddleArray<int, 4, stm::OverflowPolicy::Overwrite> ring{1, 2, 3, 4};
+    assert(ring.push_back(5) && ring.front() == 2 && ring.back() == 5);
+    assert(ring.push_front(0) && ring.front() == 0 && ring.back() == 4);
+    assert(ring.push_back(ring.front()) && ring.front() == 2 && ring.back() == 0);
+
+    // Overwrite wraps around the slots: matches a deque that evicts the same way
+    StaticShiftToMiddleArray<std::string, 16, stm::OverflowPolicy::Overwrite> w;
+    std::deque<std::string> wref;
+    for (int i = 0; i < 20000; ++i) {
+        const std::string v = std::to_string(i);
+        const unsigned op = rng() % 10;
+        if (op < 4) {
+            if (wref.size() == 16) wref.pop_front();
+            w.push_back(v);
+            wref.push_back(v);
+        } else if (op < 7) {
+            if (wref.size() == 16) wref.pop_back();
+            w.push_front(v);
+            wref.push_front(v);
+        } else if (op < 8) {
+            size_t at = rng() % (wref.size() + 1);
+            w.insert(at, v);
+            if (wref.size() == 16) {
+                if (at > wref.size() - at) { wref.pop_front(); --at; }
+                else wref.pop_back();
+            }
+            wref.insert(wref.begin() + static_cast<std::ptrdiff_t>(at), v);
+        } else if (!wref.empty() && op < 9) {
+            const size_t at = rng() % wref.size();
+            w.delete_at(at);
+            wref.erase(wref.begin() + static_cast<std::ptrdiff_t>(at));
+        } else if (!wref.empty()) { w.pop_back(); wref.pop_back(); }
+        assert(std::equal(w.begin(), w.end(), wref.begin(), wref.end()));
+        assert(std::equal(w.crbegin(), w.crend(), wref.crbegin(), wref.crend()));
+    }
+    [[maybe_unused]] const auto w_copy = w;
+    assert(w_copy == w && w_copy.end() - w_copy.begin() == static_cast<std::ptrdiff_t>(wref.size()));
+
+    // Sustained overwriting moves no stored element, only the incoming ones
+    StaticShiftToMiddleArray<MoveCounted, 64, stm::OverflowPolicy::Overwrite> window;
+    for (int i = 0; i < 64; ++i) window.push_back(MoveCounted(i));
+    MoveCounted::moves = 0;
+    for (int i = 64; i < 10000; ++i) window.push_back(MoveCounted(i));
+    for (int i = 0; i < 1000; ++i) window.push_front(MoveCounted(-i));
+    assert(MoveCounted::moves <= 2 * (10000 - 64 + 1000));
+    assert(window.full() && window.front().value == -999 && window.back().value == -936);
+
+    // Copies, moves and swaps with non-trivial elements
+    StaticShiftToMiddleArray<std::string, 8> s{"x", "y"};
+    auto copy = s;
+    auto moved = std::move(copy);
+    assert(moved == s && copy.empty());
+    StaticShiftToMiddleArray<std::string, 8> t{"z"};
+    swap(s, t);
+    assert(s.size() == 1 && s[0] == "z" && t.size() == 2 && t[1] == "y");
+}
+
+// Each kernel at instruction set I against the std:: algorithms, for sizes
+// around the vector widths
+template <stm::simd::Isa I, typename T>
+static void check_simd_kernels(std::mt19937& rng) {
+    namespace simd = stm::simd;
+    for (size_t n : {0, 1, 7, 31, 32, 63, 65, 127, 200, 1000, 5000}) {
+        std::vector<T> v(n);
+        for (T& x : v) x = static_cast<T>(rng() % 40);
+        const T* first = v.data();
+        const T* last = first + n;
+        for (T value : {T(0), T(17), T(39), T(41)}) {
+            assert(simd::find<I>(first, last, value) == std::find(first, last, value));
+            assert(simd::count<I>(first, last, value) == static_cast<size_t>(std::count(first, last, value)));
+        }
+        if (n > 0) {
+            assert((simd::extreme<I, false>(first, last)) == std::min_element(first, last));
+            assert((simd::extreme<I, true>(first, last)) == std::max_element(first, last));
+        }
+        // The sum stays exact (no overflow or rounding) in these cases
+        if (sizeof(T) >= 4 || n <= 127 / 39) {
+            T expected{};
+            for (T x : v) expected = static_cast<T>(expected + x);
+            assert(simd::sum<I>(first, last) == expected);
+        }
+        std::sort(v.begin(), v.end());
+        for (T value : {T(0), T(1), T(20), T(39), T(40)}) {
+            assert(simd::lower_bound<I>(first, last, value) == std::lower_bound(first, last, value));
+        }
+    }
+    std::vector<T> ones(100000, T(1));
+    ones[99999] = T(2);
+    assert(simd::count<I>(ones.data(), ones.data() + ones.size(), T(1)) == 99999);  // lane counters flush
+    assert(simd::find<I>(ones.data(), ones.data() + ones.size(), T(2)) == ones.data() + 99999);
+}
+
+template <stm::simd::Isa I>
+static void check_simd_kernels_all_types(std::mt19937& rng) {
+    check_simd_kernels<I, signed char>(rng);
+    check_simd_kernels<I, unsigned char>(rng);
+    check_simd_kernels<I, short>(rng);
+    check_simd_kernels<I, unsigned short>(rng);
+    check_simd_kernels<I, int>(rng);
+    check_simd_kernels<I, unsigned>(rng);
+    check_simd_kernels<I, long long>(rng);
+    check_simd_kernels<I, float>(rng);
+    check_simd_kernels<I, double>(rng);
+}
+
+static void test_simd_kernels() {
+    // Every level this CPU supports gives the std:: results
+    using stm::simd::Isa;
+    std::mt19937 rng(17);
+    check_simd_kernels_all_types<Isa::Scalar>(rng);
+    if (stm::simd::detected_isa() >= Isa::Avx2) check_simd_kernels_all_types<Isa::Avx2>(rng);
+    if (stm::simd::detected_isa() >= Isa::Avx512) check_simd_kernels_all_types<Isa::Avx512>(rng);
+
+    // Members, over a window that does not start at the block
+    ShiftToMiddleArray<int> a;
+    for (int i = 0; i < 500; ++i) { a.push_back(2 * i); a.push_front(-2 * i - 2); }
+    assert(a.find(10) - a.begin() == 505 && a.find(11) == a.end());
+    assert(a.contains(-1000) && !a.contains(-1002) && a.count(0) == 1);
+    assert(a.min() == -1000 && a.max() == 998 && a.sum() == -1000);
+    assert(a.lower_bound(-999) - a.begin() == 1 && a.lower_bound(-1) - a.begin() == 500 && a.lower_bound(5000) == a.end());
+    const ShiftToMiddleArray<int>& ca = a;
+    assert(*ca.find(4) == 4 && *ca.lower_bound(3) == 4);
+
+    // Ring mode: the members see the elements in order
+    ShiftToMiddleArray<int, 2, std::allocator<int>, RingPolicy> ring(16);
+    for (int i = 0; i < 1000; ++i) { ring.push_back(i); if (ring.size() > 10) ring.pop_front(); }
+    assert(ring.min() == 990 && ring.max() == 999 && ring.find(995) - ring.begin() == 5);
+
+    // ... also when each member is called on a wrapped window
+    int next = 1000;
+    const auto wrap = [&] {
+        do { ring.push_back(next++); ring.pop_front(); } while (ring.is_contiguous());
+    };
+    wrap();
+    assert(ring.sum() == 10 * (next - 10) + 45);
+    wrap();
+    assert(ring.min() == next - 10);
+    wrap();
+    assert(ring.max() == next - 1);
+    wrap();
+    assert(ring.count(next - 3) == 1 && !ring.contains(next));
+    wrap();
+    assert(ring.contains(next - 10));
+    wrap();
+    assert(*ring.find(next - 4) == next - 4 && ring.find(next) == ring.end());
+    wrap();
+    assert(*ring.lower_bound(next - 6) == next - 6 && ring.lower_bound(next) == ring.end());
+    wrap();
+    assert(std::as_const(ring).count(next - 2) == 1 && !ring.is_contiguous());
+
+    // Non-arithmetic elements take the scalar path
+    ShiftToMiddleArray<std::string> s;
+    for (const char* v : {"b", "d", "d", "f"}) s.push_back(v);
+    assert(s.count("d") == 2 && s.contains("f") && s.min() == "b" && s.max() == "f");
+    assert(*s.lower_bound("c") == "d" && s.sum() == "bddf");
+}
+
+static void test_parallel_algorithms() {
+    // Small grains and more threads than chunks of work, against the serial algorithms
+    for (size_t n : {0, 1, 5, 1000, 100003}) {
+        for (stm::parallel::Options options : {stm::parallel::Options{}, stm::parallel::Options{7, 4}, stm::parallel::Options{1000, 3}}) {
+            std::mt19937 rng(static_cast<unsigned>(n));
+            ShiftToMiddleArray<long long> a;
+            std::vector<long long> ref;
+            for (size_t i = 0; i < n; ++i) {
+                const long long v = static_cast<long long>(rng() % 100000) - 50000;
+                if (i % 3 == 0) { a.push_front(v); ref.insert(ref.begin(), v); }
+                else { a.push_back(v); ref.push_back(v); }
+            }
+
+            stm::parallel::for_each(a, [](long long& v) { v *= 3; }, options);
+            std::for_each(ref.begin(), ref.end(), [](long long& v) { v *= 3; });
+            assert(std::equal(a.begin(), a.end(), ref.begin(), ref.end()));
+
+            stm::parallel::transform(a, [](long long v) { return v - 7; }, options);
+            std::transform(ref.begin(), ref.end(), ref.begin(), [](long long v) { return v - 7; });
+            std::vector<long long> out(n);
+            stm::parallel::transform(a, out, [](long long v) { return v / 2; }, options);
+            for (size_t i = 0; i < n; ++i) assert(out[i] == ref[i] / 2);
+
+            assert(stm::parallel::reduce(a, 11LL, std::plus<>(), options) == std::accumulate(ref.begin(), ref.end(), 11LL));
+            // In order: a non-commutative (but associative) op gives the serial result
+            const auto keep_first = [](long long x, long long) { return x; };
+            assert(stm::parallel::reduce(a, -1LL, keep_first, options) == -1);
+
+            stm::parallel::inclusive_scan(a, std::plus<>(), options);
+            std::inclusive_scan(ref.begin(), ref.end(), ref.begin());
+            assert(std::equal(a.begin(), a.end(), ref.begin(), ref.end()));
+
+            stm::parallel::sort(a, std::greater<>(), options);
+            std::sort(ref.begin(), ref.end(), std::greater<>());
+            assert(std::equal(a.begin(), a.end(), ref.begin(), ref.end()));
+        }
+    }
+
+    // Non-trivial elements and a rethrown exception
+    ShiftToMiddleArray<std::string> s;
+    for (int i = 0; i < 5000; ++i) s.push_back(std::to_string((i * 7919) % 5000));
+    const stm::parallel::Options options{64, 4};
+    stm::parallel::sort(s, std::less<>(), options);
+    assert(std::is_sorted(s.begin(), s.end()) && s.size() == 5000);
+    assert(stm::parallel::reduce(s, std::string(), std::plus<>(), options) == std::accumulate(s.begin(), s.end(), std::string()));
+    bool thrown = false;
+    try {
+        stm::parallel::for_each(s, [](std::string& v) { if (v == "4321") throw std::runtime_error("element"); }, options);
+    } catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+}
+
+static void test_large_copy_path() {
+    // Overlapping streamed moves in both directions match std::memmove
+    std::vector<unsigned char> buf(1 << 16), ref;
+    for (size_t trial = 0; trial < 500; ++trial) {
+        for (size_t i = 0; i < buf.size(); ++i) buf[i] = static_cast<unsigned char>(i * 31 + trial);
+        ref = buf;
+        const size_t n = (trial * 7919) % (1 << 15), from = (trial * 104729) % (1 << 15), to = (trial * 1299709) % (1 << 15);
+        std::memmove(ref.data() + to, ref.data() + from, n);
+        stm::detail::stream_move(buf.data() + to, buf.data() + from, n);
+        assert(buf == ref);
+    }
+
+    // Every relocation above 1 KiB streams
+    ShiftToMiddleArray<int, 2, std::allocator<int>, stm::LargeCopyPolicy<1024, ShrinkingPolicy>> a;
+    std::deque<int> expected;
+    std::mt19937 rng(19);
+    for (int i = 0; i < 200000; ++i) {
+        const unsigned op = rng() % 8;
+        if (op < 3) { a.push_back(i); expected.push_back(i); }
+        else if (op < 5) { a.push_front(i); expected.push_front(i); }
+        else if (op < 6 && !expected.empty()) { a.pop_front(); expected.pop_front(); }
+        else if (op < 7 && !expected.empty()) { a.pop_back(); expected.pop_back(); }
+        else if (i % 1000 == 0) a.shrink_to_fit();
+    }
+    assert(std::equal(a.begin(), a.end(), expected.begin(), expected.end()));
+}
+
+static void test_incremental_resize_matches_deque() {
+    IncrementalShiftToMiddleArray<std::string> s(4);
+    std::deque<std::string> ref;
+    std::mt19937 rng(7);
+    bool migrated = false;
+    for (int i = 0; i < 50000; ++i) {
+        const std::string v = std::to_string(i);
+        switch (rng() % 6) {
+            case 0: s.push_front(v); ref.push_front(v); break;
+            case 1: case 2: s.push_back(v); ref.push_back(v); break;
+            case 3: if (!ref.empty()) { s.pop_front(); ref.pop_front(); } break;
+            case 4: if (!ref.empty()) { s.pop_back(); ref.pop_back(); } break;
+            case 5: if (!ref.empty()) { const size_t k = rng() % ref.size(); assert(s[k] == ref[k]); } break;
+        }
+        migrated = migrated || s.is_migrating();
+        assert(s.size() == ref.size());
+        if (!ref.empty()) assert(s.front() == ref.front() && s.back() == ref.back());
+    }
+    assert(migrated);
+
+    auto copy = s;
+    s.finish_migration();
+    assert(!s.is_migrating());
+    for (size_t i = 0; i < ref.size(); ++i) assert(s.data()[i] == ref[i] && copy[i] == ref[i]);
+}
+
+// Copyable only (no move constructor), so migration has to copy; the copy
+// constructor throws once the budget of allowed copies is used up
+struct CopyOnlyBudget {
+    static inline int copies_left = -1;  // < 0: unlimited
+    std::string v;  // long enough to live on the heap
+    explicit CopyOnlyBudget(int x) : v(std::string(32, 'x') + std::to_string(x)) {}
+    CopyOnlyBudget(const CopyOnlyBudget& o) : v(o.v) {
+        if (copies_left == 0) throw std::runtime_error("copy budget exhausted");
+        if (copies_left > 0) --copies_left;
+    }
+    CopyOnlyBudget& operator=(const CopyOnlyBudget&) = default;
+};
+
+static void test_incremental_resize_copy_throws() {
+    // A copy throwing partway through a migration step leaves every element
+    // readable where slot() finds it, and the migration can carry on
+    IncrementalShiftToMiddleArray<CopyOnlyBudget> s(4);
+    int pushed = 0;
+    bool threw = false;
+    for (int budget = 1; budget < 6; ++budget) {
+        while (!s.is_migrating()) s.push_back(CopyOnlyBudget(pushed++));
+        CopyOnlyBudget::copies_left = budget;
+        try {
+            while (s.is_migrating()) s.push_back(CopyOnlyBudget(pushed++));
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        CopyOnlyBudget::copies_left = -1;
+        pushed = static_cast<int>(s.size());
+        for (int i = 0; i < pushed; ++i) assert(s[static_cast<size_t>(i)].v == CopyOnlyBudget(i).v);
+    }
+    assert(threw);
+    s.finish_migration();
+    for (int i = 0; i < pushed; ++i) assert(s.data()[i].v == CopyOnlyBudget(i).v);
+}
+
+static void test_incremental_resize_aliasing_push() {
+    // Relocations that keep throwing leave a migration pending until the next
+    // edge. Pushing an element that is still in the old block across that edge
+    // must not read it after the old block is freed.
+    for (const bool at_front : {false, true}) {
+        IncrementalShiftToMiddleArray<CopyOnlyBudget> s(4);
+        std::deque<std::string> ref;
+        for (int next = 0;; ++next) {
+            const size_t before = s.size();
+            CopyOnlyBudget::copies_left = 1;  // the pushed element's copy succeeds, every migration step throws
+            try {
+                if (at_front) s.push_front(CopyOnlyBudget(next));
+                else s.push_back(CopyOnlyBudget(next));
+            } catch (const std::runtime_error&) {
+            }
+            CopyOnlyBudget::copies_left = -1;
+            if (s.size() == before) break;  // the second edge: finishing the first migration threw
+            if (at_front) ref.push_front(CopyOnlyBudget(next).v);
+            else ref.push_back(CopyOnlyBudget(next).v);
+        }
+        assert(s.is_migrating());
+        if (at_front) {
+            s.push_front(std::move(s.back()));
+            ref.push_front(ref.back());
+        } else {
+            s.push_back(s.front());
+            ref.push_back(ref.front());
+        }
+        assert(s.size() == ref.size());
+        for (size_t i = 0; i < ref.size(); ++i) assert(s[i].v == ref[i]);
+    }
+}
+
+static void test_incremental_resize_bounded_steps() {
+    // Growth must never fall back to a full migration: once started, every
+    // migration finishes before the next edge is reached.
+    IncrementalShiftToMiddleArray<int> s(2);
+    size_t grows = 0, capacity = s.capacity();
+    for (int i = 0; i < 100000; ++i) {
+        if (i % 3 == 0) s.push_front(i);
+        else s.push_back(i);
+        if (s.capacity() != capacity) {
+            ++grows;
+            capacity = s.capacity();
+        }
+    }
+    assert(grows > 10 && s.size() == 100000);
+
+    // After at most one more growth, FIFO traffic keeps recentering into same-sized blocks
+    for (int i = 0; i < 300000; ++i) {
+        s.push_back(i);
+        s.pop_front();
+    }
+    capacity = s.capacity();
+    for (int i = 0; i < 300000; ++i) {
+        s.push_back(i);
+        s.pop_front();
+    }
+    assert(s.capacity() == capacity && s.back() == 299999);
+
+    s.clear();
+    assert(s.empty() && !s.is_migrating());
+}
+
+#ifdef __linux__
+static void test_virtual_memory_growth_never_moves() {
+    ShiftToMiddleArray<int, 2, VirtualMemoryAllocator<int, (size_t(1) << 30)>> s;
+    s.push_back(42);
+    const int* anchor = &s.front();
+    for (int i = 0; i < 200000; ++i) {
+        s.push_back(i);
+        s.push_front(-i);
+    }
+    assert(&s[200000] == anchor && *anchor == 42);
+    assert(s.size() == 400001 && s.front() == -199999 && s.back() == 199999);
+
+    // FIFO traffic slides the block through the reservation instead of shifting
+    ShiftToMiddleArray<int, 2, VirtualMemoryAllocator<int, (size_t(1) << 30)>> q;
+    for (int i = 0; i < 1000; ++i) q.push_back(i);
+    q.reserve_back(2000);
+    const size_t capacity = q.capacity();
+    for (int i = 1000; i < 500000; ++i) {
+        const int* oldest = &q.back();
+        q.push_back(i);
+        q.pop_front();
+        assert(&q[q.size() - 2] == oldest);
+    }
+    assert(q.capacity() == capacity && q.front() == 499000 && q.back() == 499999);
+
+    auto copy = q;
+    assert(copy == q);
+}
+
+// Number of resident pages in [first, last) (whole pages only)
+static size_t resident_pages(const void* first, const void* last) {
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = (reinterpret_cast<uintptr_t>(first) + page - 1) & ~(page - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(last) & ~(page - 1);
+    if (begin >= end) return 0;
+    std::vector<unsigned char> pages((end - begin) / page);
+    if (mincore(reinterpret_cast<void*>(begin), end - begin, pages.data()) != 0) return 0;
+    return static_cast<size_t>(std::count_if(pages.begin(), pages.end(), [](unsigned char v) { return v & 1; }));
+}
+
+struct PageReleaseStatsPolicy : stm::PageReleasePolicy<> {
+    static constexpr bool collect_stats = true;
+    static constexpr size_t huge_page_threshold = size_t(1) << 21;
+};
+
+static void test_page_release_shrinking() {
+    // Draining keeps the block and its address, and returns the pages in front
+    ShiftToMiddleArray<int, 2, std::allocator<int>, PageReleaseStatsPolicy> q;
+    for (int i = 0; i < 4000000; ++i) q.push_back(i);
+    [[maybe_unused]] const size_t capacity = q.capacity();
+    [[maybe_unused]] const size_t reallocations = q.stats().reallocations;
+    const int* last = &q.back();
+    [[maybe_unused]] const size_t resident_before = resident_pages(&q.front(), last);
+    while (q.size() > 1000) q.pop_front();
+    assert(q.capacity() == capacity && q.stats().reallocations == reallocations && &q.back() == last);
+    assert(q.front() == 3999000 && q.back() == 3999999);
+    assert(resident_pages(q.data() - q.front_capacity(), q.data()) < resident_before / 100);
+
+    // The released pages come back on demand
+    for (int i = 0; i < 100000; ++i) q.push_front(-i);
+    assert(q.size() == 101000 && q.front() == -99999 && q[100000] == 3999000);
+
+    // Hitting an edge of a sparse window recenters in the same block
+    ShiftToMiddleArray<int, 2, std::allocator<int>, PageReleaseStatsPolicy> e;
+    for (int i = 0; i < 100000; ++i) e.push_back(i);
+    while (e.size() > 100) e.pop_front();
+    [[maybe_unused]] const size_t e_capacity = e.capacity();
+    [[maybe_unused]] const size_t e_reallocations = e.stats().reallocations;
+    [[maybe_unused]] const int* block = e.data() - e.front_capacity();
+    assert(e.size() < e_capacity / PageReleaseStatsPolicy::shrink_divisor);
+    while (e.back_capacity() > 0) { e.push_back(0); e.pop_front(); }
+    e.push_back(1);
+    assert(e.capacity() == e_capacity && e.stats().reallocations == e_reallocations);
+    assert(e.data() - e.front_capacity() == block && e.size() == 101 && e.back() == 1);
+
+    // Lazily (MADV_FREE) and through shrink_to_fit(), with non-trivial elements
+    ShiftToMiddleArray<std::string, 2, std::allocator<std::string>, stm::PageReleasePolicy<stm::ShrinkMode::ReleasePagesLazily>> s;
+    for (int i = 0; i < 300000; ++i) s.push_back(std::to_string(i));
+    for (int i = 0; i < 299000; ++i) s.pop_back();
+    s.shrink_to_fit();
+    for (int i = 0; i < 1000; ++i) assert(s[static_cast<size_t>(i)] == std::to_string(i));
+    for (int i = 0; i < 300000; ++i) s.push_front("x");
+    assert(s.size() == 301000 && s.back() == "999");
+}
+#endif
+
 int main() {
     std::cout << "Running API coverage tests..." << std::endl;
     std::cout << "  - test_aliases_and_capacity" << std::endl;
@@ -131,6 +1445,60 @@ int main() {
     test_non_trivial_vector_insert_delete();
     std::cout << "  - test_random_access_iterator_ops" << std::endl;
     test_random_access_iterator_ops();
+    std::cout << "  - test_relocation_moves_non_trivial" << std::endl;
+    test_relocation_moves_non_trivial();
+    std::cout << "  - test_trivially_relocatable_unique_ptr" << std::endl;
+    test_trivially_relocatable_unique_ptr();
+    std::cout << "  - test_pmr_arena_allocation" << std::endl;
+    test_pmr_arena_allocation();
+    std::cout << "  - test_pmr_non_trivial_elements" << std::endl;
+    test_pmr_non_trivial_elements();
+    std::cout << "  - test_bulk_append_prepend_assign" << std::endl;
+    test_bulk_append_prepend_assign();
+    std::cout << "  - test_reserve_front_back" << std::endl;
+    test_reserve_front_back();
+    std::cout << "  - test_policy_configuration" << std::endl;
+    test_policy_configuration();
+    std::cout << "  - test_adaptive_growth" << std::endl;
+    test_adaptive_growth();
+    std::cout << "  - test_adaptive_bias_follows_workload" << std::endl;
+    test_adaptive_bias_follows_workload();
+    std::cout << "  - test_drift_aware_recentering" << std::endl;
+    test_drift_aware_recentering();
+    std::cout << "  - test_ring_wrap_mode" << std::endl;
+    test_ring_wrap_mode();
+    std::cout << "  - test_self_aliasing_arguments" << std::endl;
+    test_self_aliasing_arguments();
+    std::cout << "  - test_bulk_consume" << std::endl;
+    test_bulk_consume();
+    std::cout << "  - test_range_insert_erase" << std::endl;
+    test_range_insert_erase();
+    std::cout << "  - test_erase_if_and_unique" << std::endl;
+    test_erase_if_and_unique();
+    std::cout << "  - test_small_inline_storage" << std::endl;
+    test_small_inline_storage();
+    std::cout << "  - test_static_array" << std::endl;
+    test_static_array();
+    std::cout << "  - test_simd_kernels" << std::endl;
+    test_simd_kernels();
+    std::cout << "  - test_parallel_algorithms" << std::endl;
+    test_parallel_algorithms();
+    std::cout << "  - test_large_copy_path" << std::endl;
+    test_large_copy_path();
+    std::cout << "  - test_incremental_resize_matches_deque" << std::endl;
+    test_incremental_resize_matches_deque();
+    std::cout << "  - test_incremental_resize_bounded_steps" << std::endl;
+    test_incremental_resize_bounded_steps();
+    std::cout << "  - test_incremental_resize_copy_throws" << std::endl;
+    test_incremental_resize_copy_throws();
+    std::cout << "  - test_incremental_resize_aliasing_push" << std::endl;
+    test_incremental_resize_aliasing_push();
+#ifdef __linux__
+    std::cout << "  - test_virtual_memory_growth_never_moves" << std::endl;
+    test_virtual_memory_growth_never_moves();
+    std::cout << "  - test_page_release_shrinking" << std::endl;
+    test_page_release_shrinking();
+#endif
     std::cout << "API coverage tests passed." << std::endl;
     return 0;
 }
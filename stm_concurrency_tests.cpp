@@ -0,0 +1,710 @@
+// The operations under test run inside assert(): keep them in Release builds
+#undef NDEBUG
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AsyncShiftToMiddleQueue.h"
+#include "ShiftToMiddleChannel.h"
+#include "SnapshotShiftToMiddleArray.h"
+#include "SpscShiftToMiddleQueue.h"
+#include "WorkStealingPool.h"
+
+static void test_spsc_single_thread() {
+    SpscShiftToMiddleQueue<std::string> q(4, 16);
+    int out_of = 0;
+    std::string s;
+    assert(q.empty() && !q.try_pop_front(s));
+
+    // Crosses several blocks with nothing consumed, then drains in order
+    for (int i = 0; i < 100; ++i) q.push_back(std::to_string(i));
+    for (int i = 0; i < 100; ++i) {
+        assert(q.try_pop_front(s));
+        assert(s == std::to_string(out_of));
+        ++out_of;
+    }
+    assert(q.empty());
+
+    // Batches: push_back_n across a boundary, then front_span / pop_front_n
+    std::vector<std::string> batch;
+    for (int i = 100; i < 150; ++i) batch.push_back(std::to_string(i));
+    q.push_back_n(batch.begin(), batch.size());
+    q.emplace_back(3, 'x');
+    while (out_of < 150) {
+        std::span<std::string> span = q.front_span();
+        assert(!span.empty());
+        const size_t take = std::min<size_t>({span.size(), 7, static_cast<size_t>(150 - out_of)});
+        for (size_t i = 0; i < take; ++i, ++out_of) assert(span[i] == std::to_string(out_of));
+        q.pop_front_n(take);
+    }
+    assert(q.try_pop_front(s) && s == "xxx");
+    assert(q.empty() && q.front_span().empty());
+
+    // Leftovers are destroyed with the queue
+    for (int i = 0; i < 37; ++i) q.push_back(std::string(40, 'a'));
+    assert(q.try_pop_front(s));
+}
+
+static void test_spsc_prepare_commit() {
+    SpscShiftToMiddleQueue<int> q(8, 8);
+    // Larger than any block: gets a block of its own
+    std::span<int> slots = q.prepare_back(20);
+    assert(slots.size() >= 20);
+    std::iota(slots.begin(), slots.begin() + 20, 0);
+    q.commit_back(12);  // only the first 12 become visible
+    int v = -1;
+    for (int i = 0; i < 12; ++i) assert(q.try_pop_front(v) && v == i);
+    assert(!q.try_pop_front(v));
+    slots = q.prepare_back(3);
+    slots[0] = 99;
+    q.commit_back(1);
+    assert(q.try_pop_front(v) && v == 99 && q.empty());
+}
+
+// One producer, one consumer, mixing single and batched operations on both
+// sides; every value must arrive once, in order
+static void test_spsc_two_threads() {
+    constexpr uint64_t total = 2000000;
+    SpscShiftToMiddleQueue<uint64_t> q(64, 4096);
+
+    std::thread producer([&] {
+        std::vector<uint64_t> batch;
+        uint64_t next = 0;
+        while (next < total) {
+            const uint64_t n = std::min<uint64_t>(total - next, 1 + next % 97);
+            if (next % 3 == 0) {
+                for (uint64_t i = 0; i < n; ++i) q.push_back(next++);
+            } else if (next % 3 == 1) {
+                batch.resize(n);
+                std::iota(batch.begin(), batch.end(), next);
+                q.push_back_n(batch.begin(), n);
+                next += n;
+            } else {
+                std::span<uint64_t> slots = q.prepare_back(n);
+                for (uint64_t i = 0; i < n; ++i) slots[i] = next + i;
+                q.commit_back(n);
+                next += n;
+            }
+        }
+    });
+
+    uint64_t expected = 0;
+    while (expected < total) {
+        if (expected % 2 == 0) {
+            uint64_t v;
+            if (q.try_pop_front(v)) {
+                assert(v == expected);
+                ++expected;
+                continue;
+            }
+        } else {
+            std::span<uint64_t> span = q.front_span();
+            for (uint64_t v : span) {
+                assert(v == expected);
+                ++expected;
+            }
+            q.pop_front_n(span.size());
+            if (!span.empty()) continue;
+        }
+        std::this_thread::yield();
+    }
+    producer.join();
+    assert(q.empty());
+}
+
+// Non-trivial elements handed across threads are moved, not shared
+static void test_spsc_two_threads_owning() {
+    constexpr int total = 200000;
+    SpscShiftToMiddleQueue<std::unique_ptr<int>> q(16, 1024);
+    std::thread producer([&] {
+        for (int i = 0; i < total; ++i) q.emplace_back(std::make_unique<int>(i));
+    });
+    std::unique_ptr<int> p;
+    for (int expected = 0; expected < total;) {
+        if (q.try_pop_front(p)) {
+            assert(p && *p == expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
+
+// Copying a negative one throws
+struct Fragile {
+    int v;
+    explicit Fragile(int v) : v(v) {}
+    Fragile(const Fragile& other) : v(other.v) {
+        if (v < 0) throw std::runtime_error("copy failed");
+    }
+    Fragile(Fragile&&) noexcept = default;
+    Fragile& operator=(const Fragile&) = default;
+    Fragile& operator=(Fragile&&) noexcept = default;
+};
+
+static void test_channel_single_thread() {
+    ShiftToMiddleChannel<std::string> ch(8, 2);
+    assert(ch.high_watermark() == 8 && ch.low_watermark() == 2);
+    assert(!ch.try_pop());
+
+    for (int i = 0; i < 8; ++i) assert(ch.try_push(std::to_string(i)));
+    assert(!ch.try_push("full") && ch.size() == 8);
+
+    // Throttled until drained to the low watermark
+    assert(*ch.pop() == "0");
+    assert(!ch.try_push("still throttled"));
+    std::vector<std::string> out;
+    assert(ch.pop_batch(std::back_inserter(out), 5) == 5 && out.back() == "5");
+    assert(ch.size() == 2 && ch.try_push("8"));
+
+    std::vector<std::string> more = {"9", "10"};
+    assert(ch.push_batch(std::span<const std::string>(more)) == 2);
+    assert(ch.try_pop_batch(std::back_inserter(out), 100) == 5);
+    assert(out.size() == 10 && out[9] == "10");
+
+    // Close: queued elements still drain, pushes fail, pops stop blocking
+    ch.push("a");
+    ch.close();
+    ch.close();
+    assert(ch.closed() && !ch.push("b") && !ch.try_push("b"));
+    assert(*ch.pop() == "a");
+    assert(!ch.pop() && ch.pop_batch(std::back_inserter(out), 4) == 0);
+}
+
+// Producers and consumers mixing single and batched calls through a small
+// channel: every value arrives exactly once, and each producer's values in order
+static void test_channel_many_threads() {
+    constexpr int producers = 4, consumers = 3, per_producer = 100000;
+    ShiftToMiddleChannel<uint64_t> ch(64, 16);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            std::vector<uint64_t> batch;
+            for (int i = 0; i < per_producer;) {
+                const uint64_t value = (static_cast<uint64_t>(p) << 32) | static_cast<uint64_t>(i);
+                if (i % 5 == 0) {
+                    assert(ch.push(value));
+                    ++i;
+                } else {
+                    batch.clear();
+                    for (int k = 0; k < 37 && i < per_producer; ++k, ++i) batch.push_back((static_cast<uint64_t>(p) << 32) | static_cast<uint64_t>(i));
+                    assert(ch.push_batch(batch.begin(), batch.size()) == batch.size());
+                }
+            }
+        });
+    }
+
+    std::vector<std::vector<uint64_t>> received(consumers);
+    std::vector<std::thread> readers;
+    for (int c = 0; c < consumers; ++c) {
+        readers.emplace_back([&, c] {
+            std::vector<uint64_t>& mine = received[static_cast<size_t>(c)];
+            for (;;) {
+                if (c == 0) {
+                    std::optional<uint64_t> v = ch.pop();
+                    if (!v) break;
+                    mine.push_back(*v);
+                } else if (ch.pop_batch(std::back_inserter(mine), 50) == 0) {
+                    break;
+                }
+            }
+        });
+    }
+
+    for (std::thread& t : threads) t.join();
+    ch.close();
+    for (std::thread& t : readers) t.join();
+
+    std::vector<uint64_t> seen(producers, 0);
+    size_t total = 0;
+    for (const std::vector<uint64_t>& mine : received) {
+        std::vector<int64_t> last(producers, -1);
+        for (uint64_t v : mine) {
+            const size_t p = static_cast<size_t>(v >> 32);
+            const int64_t i = static_cast<int64_t>(v & 0xffffffffu);
+            assert(i > last[p]);  // per-producer order survives within one consumer
+            last[p] = i;
+            ++seen[p];
+        }
+        total += mine.size();
+    }
+    assert(total == static_cast<size_t>(producers) * per_producer);
+    for (uint64_t n : seen) assert(n == per_producer);
+}
+
+// A batch that throws partway still wakes a consumer for what it queued
+static void test_channel_throwing_batch() {
+    ShiftToMiddleChannel<Fragile> ch(16);
+    std::optional<Fragile> received;
+    std::thread consumer([&] { received = ch.pop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));  // let it block
+    std::vector<Fragile> batch;
+    batch.emplace_back(1);
+    batch.emplace_back(-1);
+    bool threw = false;
+    try {
+        ch.push_batch(batch.begin(), batch.size());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    consumer.join();
+    assert(threw && received && received->v == 1 && ch.size() == 0);
+}
+
+// close() releases producers blocked on a full channel
+static void test_channel_close_wakes_producers() {
+    ShiftToMiddleChannel<int> ch(4);
+    for (int i = 0; i < 4; ++i) assert(ch.push(i));
+    std::vector<std::thread> blocked;
+    std::atomic<int> refused{0};
+    for (int t = 0; t < 3; ++t) {
+        blocked.emplace_back([&] {
+            if (!ch.push(99)) ++refused;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ch.close();
+    for (std::thread& t : blocked) t.join();
+    assert(refused == 3);
+    std::vector<int> out;
+    assert(ch.pop_batch(std::back_inserter(out), 10) == 4 && out == std::vector<int>({0, 1, 2, 3}));
+}
+
+static void test_work_stealing_deque_single_thread() {
+    WorkStealingDeque<int> d(4);
+    int v = -1;
+    assert(d.empty() && !d.pop_back(v) && !d.steal_front(v));
+
+    // Wraps around the block, then grows while wrapped
+    for (int i = 0; i < 3; ++i) d.push_back(i);
+    assert(d.steal_front(v) && v == 0 && d.steal_front(v) && v == 1);
+    for (int i = 3; i < 40; ++i) d.push_back(i);
+    assert(d.size() == 38 && d.capacity() >= 38);
+    assert(d.pop_back(v) && v == 39 && d.steal_front(v) && v == 2);
+    for (int i = 38; i >= 3; --i) assert(d.pop_back(v) && v == i);
+    assert(d.empty() && !d.pop_back(v) && !d.steal_front(v));
+}
+
+// The owner pushes and pops while thieves steal: every element is taken
+// exactly once
+static void test_work_stealing_deque_thieves() {
+    constexpr int total = 300000, thieves = 3;
+    WorkStealingDeque<int> d(8);
+    std::vector<std::atomic<int>> taken(total);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thieves; ++t) {
+        threads.emplace_back([&] {
+            int v;
+            while (!done.load(std::memory_order_acquire)) {
+                if (d.steal_front(v)) taken[static_cast<size_t>(v)].fetch_add(1);
+                else std::this_thread::yield();
+            }
+        });
+    }
+    int v;
+    for (int i = 0; i < total; ++i) {
+        d.push_back(i);
+        if (i % 3 == 0 && d.pop_back(v)) taken[static_cast<size_t>(v)].fetch_add(1);
+    }
+    while (d.pop_back(v)) taken[static_cast<size_t>(v)].fetch_add(1);
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+    while (d.steal_front(v)) taken[static_cast<size_t>(v)].fetch_add(1);
+    for (std::atomic<int>& n : taken) assert(n.load() == 1);
+}
+
+static long long pool_fib(WorkStealingPool& pool, int n) {
+    if (n < 12) return n < 2 ? n : pool_fib(pool, n - 1) + pool_fib(pool, n - 2);
+    long long left = 0;
+    WorkStealingPool::TaskGroup group(pool);
+    group.run([&] { left = pool_fib(pool, n - 1); });
+    const long long right = pool_fib(pool, n - 2);
+    group.wait();
+    return left + right;
+}
+
+// A task whose copy throws, so that TaskGroup::run() fails before submitting
+struct ThrowingCopyTask {
+    ThrowingCopyTask() = default;
+    ThrowingCopyTask(const ThrowingCopyTask&) { throw std::runtime_error("copy failed"); }
+    void operator()() const {}
+};
+
+static void test_work_stealing_pool() {
+    WorkStealingPool pool(3);
+    assert(pool.size() == 3);
+    assert(pool_fib(pool, 25) == 75025);
+
+    // Flat fan-out from outside the pool, through the injection queue
+    std::vector<int> out(10000, 0);
+    {
+        WorkStealingPool::TaskGroup group(pool);
+        for (size_t i = 0; i < out.size(); ++i) group.run([&out, i] { out[i] = static_cast<int>(i) * 2; });
+        group.wait();
+    }
+    for (size_t i = 0; i < out.size(); ++i) assert(out[i] == static_cast<int>(i) * 2);
+
+    // A throwing task: wait() rethrows, the group's other tasks still ran
+    std::atomic<int> ran{0};
+    WorkStealingPool::TaskGroup group(pool);
+    for (int i = 0; i < 100; ++i) {
+        group.run([&ran, i] {
+            ++ran;
+            if (i == 50) throw std::runtime_error("task failed");
+        });
+    }
+    bool threw = false;
+    try {
+        group.wait();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && ran == 100);
+    group.wait();  // the error was reported once
+
+    // A task that could not be created is not waited for
+    const ThrowingCopyTask uncopyable;
+    threw = false;
+    try {
+        group.run(uncopyable);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    group.wait();
+}
+
+static stm::LocalEventLoop::Task async_consumer(AsyncShiftToMiddleQueue<std::string>& q, std::vector<std::string>& out) {
+    while (std::optional<std::string> v = co_await q.pop()) out.push_back(*v);
+    out.push_back("closed");
+}
+
+static stm::LocalEventLoop::Task async_producer(stm::LocalEventLoop& loop, AsyncShiftToMiddleQueue<std::string>& q) {
+    for (int i = 0; i < 6; ++i) {
+        q.push(std::to_string(i));
+        co_await loop.yield();
+    }
+    q.close();
+}
+
+// Records how handles arrive, for checking that wake-ups are batched
+struct CountingExecutor {
+    stm::LocalEventLoop loop;
+    std::vector<size_t> posts;
+    void post(std::span<const std::coroutine_handle<>> handles) {
+        posts.push_back(handles.size());
+        loop.post(handles);
+    }
+};
+
+static stm::LocalEventLoop::Task counting_consumer(AsyncShiftToMiddleQueue<int, CountingExecutor>& q, std::vector<int>& out) {
+    while (std::optional<int> v = co_await q.pop()) out.push_back(*v);
+}
+
+static void test_async_queue_local_loop() {
+    stm::LocalEventLoop loop;
+    AsyncShiftToMiddleQueue<std::string> q(loop);
+
+    // Buffered elements are taken without suspending
+    q.push("a");
+    q.push("b");
+    std::vector<std::string> first;
+    loop.spawn([](AsyncShiftToMiddleQueue<std::string>& q, std::vector<std::string>& out) -> stm::LocalEventLoop::Task {
+        out.push_back(*co_await q.pop());
+        out.push_back(*co_await q.pop());
+    }(q, first));
+    assert(loop.run() == 1 && first == std::vector<std::string>({"a", "b"}));
+
+    // Two consumers suspend, the producer feeds them one element at a time,
+    // close() ends both
+    std::vector<std::string> a, b;
+    loop.spawn(async_consumer(q, a));
+    loop.spawn(async_consumer(q, b));
+    loop.spawn(async_producer(loop, q));
+    loop.run();
+    assert(loop.idle() && q.closed());
+    assert(a == std::vector<std::string>({"0", "2", "4", "closed"}));
+    assert(b == std::vector<std::string>({"1", "3", "5", "closed"}));
+    assert(!q.push("late") && q.size() == 0);
+
+    // An unstarted task is destroyed with its handle
+    { stm::LocalEventLoop::Task unstarted = async_consumer(q, a); }
+}
+
+static void test_async_queue_batched_resume() {
+    CountingExecutor ex;
+    AsyncShiftToMiddleQueue<int, CountingExecutor> q(ex);
+    std::vector<std::vector<int>> out(100);
+    for (std::vector<int>& o : out) ex.loop.spawn(counting_consumer(q, o));
+    ex.loop.run();  // all 100 suspended
+
+    // 150 elements: 100 handed to the waiters in two posts (64 + 36), 50 buffered
+    std::vector<int> values(150);
+    std::iota(values.begin(), values.end(), 0);
+    assert(q.push_batch(values.begin(), values.size()) == 150);
+    assert(ex.posts == std::vector<size_t>({64, 36}) && q.size() == 50);
+    for (size_t i = 0; i < out.size(); ++i) assert(out[i].empty());
+    ex.loop.run();  // each consumer takes its element, then drains the buffer in turn
+    q.close();
+    ex.loop.run();
+    size_t total = 0;
+    for (size_t i = 0; i < out.size(); ++i) {
+        assert(!out[i].empty() && out[i][0] == static_cast<int>(i));
+        total += out[i].size();
+    }
+    assert(total == 150);
+}
+
+static stm::LocalEventLoop::Task fragile_consumer(AsyncShiftToMiddleQueue<Fragile>& q, std::vector<int>& out, int& done) {
+    while (std::optional<Fragile> v = co_await q.pop()) out.push_back(v->v);
+    ++done;
+}
+
+// A throwing element constructor neither strands the waiter it was meant for
+// nor the waiters a batch had already served
+static void test_async_queue_throwing_push() {
+    stm::LocalEventLoop loop;
+    AsyncShiftToMiddleQueue<Fragile> q(loop);
+    std::vector<int> out;
+    int done = 0;
+    loop.spawn(fragile_consumer(q, out, done));
+    loop.spawn(fragile_consumer(q, out, done));
+    loop.run();
+
+    const Fragile bad(-1);
+    bool threw = false;
+    try { q.push(bad); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw && loop.idle());
+
+    std::vector<Fragile> batch;
+    batch.emplace_back(5);
+    batch.emplace_back(-2);
+    threw = false;
+    try { q.push_batch(batch.begin(), batch.size()); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw && !loop.idle());
+    loop.run();
+    assert(out == std::vector<int>({5}));
+
+    assert(q.push(Fragile(6)) && q.push(Fragile(7)));
+    loop.run();
+    q.close();
+    loop.run();
+    assert(out == std::vector<int>({5, 6, 7}) && done == 2);
+}
+
+// A producer thread feeding coroutines that run on the main thread
+struct LockedExecutor {
+    std::mutex mutex;
+    std::vector<std::coroutine_handle<>> ready;
+    void post(std::span<const std::coroutine_handle<>> handles) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.insert(ready.end(), handles.begin(), handles.end());
+    }
+    bool run_once() {
+        std::vector<std::coroutine_handle<>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch.swap(ready);
+        }
+        for (std::coroutine_handle<> h : batch) h.resume();
+        return !batch.empty();
+    }
+};
+
+static stm::LocalEventLoop::Task summing_consumer(AsyncShiftToMiddleQueue<int, LockedExecutor>& q, long long& sum, int& done) {
+    while (std::optional<int> v = co_await q.pop()) sum += *v;
+    ++done;
+}
+
+static void test_async_queue_cross_thread() {
+    constexpr int total = 200000, consumers = 8;
+    LockedExecutor ex;
+    AsyncShiftToMiddleQueue<int, LockedExecutor> q(ex);
+    long long sum = 0;
+    int done = 0;
+    stm::LocalEventLoop starter;
+    for (int c = 0; c < consumers; ++c) starter.spawn(summing_consumer(q, sum, done));
+    starter.run();
+
+    std::thread producer([&] {
+        std::vector<int> batch;
+        for (int i = 0; i < total; ++i) {
+            if (i % 2) {
+                q.push(i);
+                continue;
+            }
+            batch.push_back(i);
+            if (batch.size() == 16) {
+                q.push_batch(batch.begin(), batch.size());
+                batch.clear();
+            }
+        }
+        q.push_batch(batch.begin(), batch.size());
+        q.close();
+    });
+    while (done < consumers) {
+        if (!ex.run_once()) std::this_thread::yield();
+    }
+    producer.join();
+    assert(sum == static_cast<long long>(total) * (total - 1) / 2);
+}
+
+static void test_snapshot_single_thread() {
+    SnapshotShiftToMiddleArray<int> a(4);
+    std::deque<int> ref;
+    assert(a.empty() && a.size() == 0 && a.snapshot().empty());
+
+    // Both ends, growth and recentering, with pushes into popped slots
+    for (int i = 0; i < 2000; ++i) {
+        switch (i % 7) {
+            case 0: case 1: case 2: a.push_back(i); ref.push_back(i); break;
+            case 3: case 4: a.push_front(i); ref.push_front(i); break;
+            case 5: a.pop_back(); ref.pop_back(); break;
+            case 6: a.pop_front(); ref.pop_front(); break;
+        }
+        assert(a.size() == ref.size() && a.front() == ref.front() && a.back() == ref.back());
+        if (i % 97 == 0) assert(a.snapshot() == std::vector<int>(ref.begin(), ref.end()));
+    }
+    for (size_t i = 0; i < ref.size(); ++i) assert(a[i] == ref[i]);
+    assert(a.retired_blocks() == 0);
+
+    std::vector<int> out{1, 2, 3};
+    a.clear();
+    assert(a.empty() && a.snapshot_into(out) == 0 && out.empty());
+    a.push_front(7);
+    a.push_back(8);
+    assert(a.snapshot() == std::vector<int>({7, 8}));
+}
+
+// FIFO traffic through a growing array: every snapshot is a run of consecutive
+// values, and readers never see a freed block (ASan) or a torn slot (TSan)
+static void test_snapshot_fifo_readers() {
+    constexpr int total = 400000, readers = 3;
+    SnapshotShiftToMiddleArray<std::uint64_t> a(8);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> snapshots{0};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            std::vector<std::uint64_t> snap;
+            while (!done.load(std::memory_order_acquire)) {
+                a.snapshot_into(snap);
+                for (size_t i = 1; i < snap.size(); ++i) assert(snap[i] == snap[i - 1] + 1);
+                snapshots.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    std::uint64_t next = 0;
+    for (int i = 0; i < total; ++i) {
+        a.push_back(next++);
+        // Let the backlog swing between ~0 and ~4000 so the array grows and recenters
+        if ((i / 4000) % 2 == 1 && !a.empty()) a.pop_front();
+        if (i % 5 == 0 && !a.empty()) a.pop_front();
+    }
+    while (snapshots.load() < readers) std::this_thread::yield();
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+    a.reclaim();
+    assert(a.retired_blocks() == 0);
+}
+
+// Pops followed by pushes at both ends rewrite slots that readers may be
+// copying: the values stay strictly increasing front to back, so a snapshot
+// mixing two states (an old window over slots pushed after two pops) shows up
+// as a descent. The array is kept large so that copies get interrupted.
+static void test_snapshot_rewrites() {
+    constexpr int total = 600000, readers = 2;
+    SnapshotShiftToMiddleArray<std::int64_t> a(16);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                const std::vector<std::int64_t> snap = a.snapshot();
+                for (size_t i = 1; i < snap.size(); ++i) assert(snap[i] > snap[i - 1]);
+            }
+        });
+    }
+    std::int64_t low = 0, high = 1;
+    std::uint64_t rng = 0x9e3779b97f4a7c15ull;
+    for (int i = 0; i < total; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        const bool shrink = a.size() > 8192;
+        switch (rng % 4) {
+            case 0: a.push_back(high++); break;
+            case 1: a.push_front(low--); break;
+            case 2: if (!a.empty() && (shrink || rng % 3)) a.pop_back(); break;
+            case 3: if (!a.empty() && (shrink || rng % 3)) a.pop_front(); break;
+        }
+        if (i % 1024 == 0) std::this_thread::yield();  // resume readers mid-copy
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+    a.reclaim();
+    assert(a.retired_blocks() == 0);
+}
+
+int main() {
+    std::cout << "Running concurrency tests..." << std::endl;
+    std::cout << "  - test_spsc_single_thread" << std::endl;
+    test_spsc_single_thread();
+    std::cout << "  - test_spsc_prepare_commit" << std::endl;
+    test_spsc_prepare_commit();
+    std::cout << "  - test_spsc_two_threads" << std::endl;
+    test_spsc_two_threads();
+    std::cout << "  - test_spsc_two_threads_owning" << std::endl;
+    test_spsc_two_threads_owning();
+    std::cout << "  - test_channel_single_thread" << std::endl;
+    test_channel_single_thread();
+    std::cout << "  - test_channel_many_threads" << std::endl;
+    test_channel_many_threads();
+    std::cout << "  - test_channel_throwing_batch" << std::endl;
+    test_channel_throwing_batch();
+    std::cout << "  - test_channel_close_wakes_producers" << std::endl;
+    test_channel_close_wakes_producers();
+    std::cout << "  - test_work_stealing_deque_single_thread" << std::endl;
+    test_work_stealing_deque_single_thread();
+    std::cout << "  - test_work_stealing_deque_thieves" << std::endl;
+    test_work_stealing_deque_thieves();
+    std::cout << "  - test_work_stealing_pool" << std::endl;
+    test_work_stealing_pool();
+    std::cout << "  - test_async_queue_local_loop" << std::endl;
+    test_async_queue_local_loop();
+    std::cout << "  - test_async_queue_batched_resume" << std::endl;
+    test_async_queue_batched_resume();
+    std::cout << "  - test_async_queue_throwing_push" << std::endl;
+    test_async_queue_throwing_push();
+    std::cout << "  - test_async_queue_cross_thread" << std::endl;
+    test_async_queue_cross_thread();
+    std::cout << "  - test_snapshot_single_thread" << std::endl;
+    test_snapshot_single_thread();
+    std::cout << "  - test_snapshot_fifo_readers" << std::endl;
+    test_snapshot_fifo_readers();
+    std::cout << "  - test_snapshot_rewrites" << std::endl;
+    test_snapshot_rewrites();
+    std::cout << "Concurrency tests passed." << std::endl;
+    return 0;
+}